@@ -0,0 +1,19 @@
+# Autodetect if AVX2 can be used.
+
+include(CheckCXXSourceCompiles)
+set(CMAKE_REQUIRED_FLAGS "")
+
+if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU" OR CMAKE_CXX_COMPILER_ID STREQUAL "Clang" OR CMAKE_CXX_COMPILER_ID STREQUAL "AppleClang")
+    set(CMAKE_REQUIRED_FLAGS "-mavx2")
+endif()
+
+check_cxx_source_compiles("
+    #include <immintrin.h>
+    int main() {
+        __m256i a = _mm256_broadcastsi128_si256(_mm_setzero_si128());
+        return _mm256_testz_si256(_mm256_packus_epi16(a, a), a);
+    }"
+    AVX2_FOUND
+)
+
+set(CMAKE_REQUIRED_FLAGS "")
@@ -98,6 +98,53 @@ static inline __m128i DarkenTwoPixels(__m128i src, __m128i dst, const __m128i &d
 	return _mm_packus_epi16(dstAB, dstAB);
 }
 
+#if (SSE_VERSION >= 5)
+/**
+ * Alpha blend 8 pixels, in the same way as AlphaBlendTwoPixels() does.
+ * Each 128 bits lane is unpacked into two halves: pixels 0, 1, 4, 5 and pixels 2, 3, 6, 7.
+ */
+static inline __m256i AlphaBlendEightPixels(__m256i src, __m256i dst, const __m256i &distribution_mask, const __m256i &clear_hi)
+{
+	__m256i srcLo = _mm256_unpacklo_epi8(src, _mm256_setzero_si256());
+	__m256i srcHi = _mm256_unpackhi_epi8(src, _mm256_setzero_si256());
+	__m256i dstLo = _mm256_unpacklo_epi8(dst, _mm256_setzero_si256());
+	__m256i dstHi = _mm256_unpackhi_epi8(dst, _mm256_setzero_si256());
+
+	__m256i alphaLo = _mm256_srli_epi16(_mm256_cmpgt_epi16(srcLo, _mm256_setzero_si256()), 15); // if (alpha > 0) a++;
+	__m256i alphaHi = _mm256_srli_epi16(_mm256_cmpgt_epi16(srcHi, _mm256_setzero_si256()), 15);
+	alphaLo = _mm256_shuffle_epi8(_mm256_add_epi16(alphaLo, srcLo), distribution_mask);
+	alphaHi = _mm256_shuffle_epi8(_mm256_add_epi16(alphaHi, srcHi), distribution_mask);
+
+	srcLo = _mm256_add_epi16(_mm256_srli_epi16(_mm256_mullo_epi16(_mm256_sub_epi16(srcLo, dstLo), alphaLo), 8), dstLo); // a*(r - Cr)/256 + Cr
+	srcHi = _mm256_add_epi16(_mm256_srli_epi16(_mm256_mullo_epi16(_mm256_sub_epi16(srcHi, dstHi), alphaHi), 8), dstHi);
+
+	/* Only the low bytes are valid, so wipe the high bytes before packing. */
+	return _mm256_packus_epi16(_mm256_and_si256(srcLo, clear_hi), _mm256_and_si256(srcHi, clear_hi));
+}
+
+/** Darken 8 pixels, in the same way as DarkenTwoPixels() does. */
+static inline __m256i DarkenEightPixels(__m256i src, __m256i dst, const __m256i &distribution_mask, const __m256i &tr_nom_base)
+{
+	__m256i srcLo = _mm256_unpacklo_epi8(src, _mm256_setzero_si256());
+	__m256i srcHi = _mm256_unpackhi_epi8(src, _mm256_setzero_si256());
+	__m256i dstLo = _mm256_unpacklo_epi8(dst, _mm256_setzero_si256());
+	__m256i dstHi = _mm256_unpackhi_epi8(dst, _mm256_setzero_si256());
+
+	__m256i nomLo = _mm256_sub_epi16(tr_nom_base, _mm256_srli_epi16(_mm256_shuffle_epi8(srcLo, distribution_mask), 2));
+	__m256i nomHi = _mm256_sub_epi16(tr_nom_base, _mm256_srli_epi16(_mm256_shuffle_epi8(srcHi, distribution_mask), 2));
+	dstLo = _mm256_srli_epi16(_mm256_mullo_epi16(dstLo, nomLo), 8);
+	dstHi = _mm256_srli_epi16(_mm256_mullo_epi16(dstHi, nomHi), 8);
+	return _mm256_packus_epi16(dstLo, dstHi);
+}
+
+/** Copy the 8 pixels that are not fully transparent. */
+static inline __m256i CopyEightOpaquePixels(__m256i src, __m256i dst, const __m256i &alpha_mask)
+{
+	__m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(src, alpha_mask), _mm256_setzero_si256());
+	return _mm256_blendv_epi8(src, dst, transparent);
+}
+#endif
+
 IGNORE_UNINITIALIZED_WARNING_START
 static Colour ReallyAdjustBrightness(Colour colour, uint8 brightness)
 {
@@ -198,6 +245,8 @@ inline void Blitter_32bppSSE2::Draw(const Blitter::BlitterParams *bp, ZoomLevel
 inline void Blitter_32bppSSSE3::Draw(const Blitter::BlitterParams *bp, ZoomLevel zoom)
 #elif (SSE_VERSION == 4)
 inline void Blitter_32bppSSE4::Draw(const Blitter::BlitterParams *bp, ZoomLevel zoom)
+#elif (SSE_VERSION == 5)
+inline void Blitter_32bppAVX2::Draw(const Blitter::BlitterParams *bp, ZoomLevel zoom)
 #endif
 {
 	const byte * const remap = bp->remap;
@@ -232,6 +281,12 @@ inline void Blitter_32bppSSE4::Draw(const Blitter::BlitterParams *bp, ZoomLevel
 	#define DARKEN_PARAM_2      tr_nom_base
 #endif
 	const __m128i tr_nom_base = TRANSPARENT_NOM_BASE;
+#if (SSE_VERSION >= 5)
+	const __m256i a_cm_8        = _mm256_broadcastsi128_si256(ALPHA_CONTROL_MASK);
+	const __m256i clear_hi_8    = _mm256_broadcastsi128_si256(CLEAR_HIGH_BYTE_MASK);
+	const __m256i tr_nom_base_8 = _mm256_broadcastsi128_si256(TRANSPARENT_NOM_BASE);
+	const __m256i alpha_mask_8  = _mm256_set1_epi32(0xFF000000);
+#endif
 
 	for (int y = bp->height; y != 0; y--) {
 		Colour *dst = dst_line;
@@ -254,7 +309,18 @@ inline void Blitter_32bppSSE4::Draw(const Blitter::BlitterParams *bp, ZoomLevel
 		switch (mode) {
 			default:
 				if (!translucent) {
+#if (SSE_VERSION >= 5)
+					for (uint x = (uint) effective_width / 8; x > 0; x--) {
+						__m256i srcABCD = _mm256_loadu_si256((const __m256i*) src);
+						__m256i dstABCD = _mm256_loadu_si256((__m256i*) dst);
+						_mm256_storeu_si256((__m256i*) dst, CopyEightOpaquePixels(srcABCD, dstABCD, alpha_mask_8));
+						src += 8;
+						dst += 8;
+					}
+					for (uint x = (uint) effective_width & 7; x > 0; x--) {
+#else
 					for (uint x = (uint) effective_width; x > 0; x--) {
+#endif
 						if (src->a) *dst = *src;
 						src++;
 						dst++;
@@ -262,7 +328,18 @@ inline void Blitter_32bppSSE4::Draw(const Blitter::BlitterParams *bp, ZoomLevel
 					break;
 				}
 
+#if (SSE_VERSION >= 5)
+				for (uint x = (uint) effective_width / 8; x > 0; x--) {
+					__m256i srcABCD = _mm256_loadu_si256((const __m256i*) src);
+					__m256i dstABCD = _mm256_loadu_si256((__m256i*) dst);
+					_mm256_storeu_si256((__m256i*) dst, AlphaBlendEightPixels(srcABCD, dstABCD, a_cm_8, clear_hi_8));
+					src += 8;
+					dst += 8;
+				}
+				for (uint x = (uint) (effective_width & 7) / 2; x > 0; x--) {
+#else
 				for (uint x = (uint) effective_width / 2; x > 0; x--) {
+#endif
 					__m128i srcABCD = _mm_loadl_epi64((const __m128i*) src);
 					__m128i dstABCD = _mm_loadl_epi64((__m128i*) dst);
 					_mm_storel_epi64((__m128i*) dst, AlphaBlendTwoPixels(srcABCD, dstABCD, ALPHA_BLEND_PARAM_1, ALPHA_BLEND_PARAM_2));
@@ -280,6 +357,19 @@ inline void Blitter_32bppSSE4::Draw(const Blitter::BlitterParams *bp, ZoomLevel
 			case BM_COLOUR_REMAP:
 #if (SSE_VERSION >= 3)
 				for (uint x = (uint) effective_width / 2; x > 0; x--) {
+#if (SSE_VERSION >= 5)
+					/* Blend 8 pixels at once when none of them has to be remapped. The loop takes care of one pair of them. */
+					if (x >= 4 && _mm_testz_si128(_mm_loadu_si128((const __m128i*) src_mv), CLEAR_HIGH_BYTE_MASK)) {
+						__m256i srcABCD = _mm256_loadu_si256((const __m256i*) src);
+						__m256i dstABCD = _mm256_loadu_si256((__m256i*) dst);
+						_mm256_storeu_si256((__m256i*) dst, AlphaBlendEightPixels(srcABCD, dstABCD, a_cm_8, clear_hi_8));
+						dst += 8;
+						src += 8;
+						src_mv += 8;
+						x -= 3;
+						continue;
+					}
+#endif
 					__m128i srcABCD = _mm_loadl_epi64((const __m128i*) src);
 					__m128i dstABCD = _mm_loadl_epi64((__m128i*) dst);
 					uint32 mvX2 = *((uint32 *) const_cast<MapValue *>(src_mv));
@@ -361,7 +451,18 @@ bmcr_alpha_blend_single:
 
 			case BM_TRANSPARENT:
 				/* Make the current colour a bit more black, so it looks like this image is transparent. */
+#if (SSE_VERSION >= 5)
+				for (uint x = (uint) bp->width / 8; x > 0; x--) {
+					__m256i srcABCD = _mm256_loadu_si256((const __m256i*) src);
+					__m256i dstABCD = _mm256_loadu_si256((__m256i*) dst);
+					_mm256_storeu_si256((__m256i*) dst, DarkenEightPixels(srcABCD, dstABCD, a_cm_8, tr_nom_base_8));
+					src += 8;
+					dst += 8;
+				}
+				for (uint x = (uint) (bp->width & 7) / 2; x > 0; x--) {
+#else
 				for (uint x = (uint) bp->width / 2; x > 0; x--) {
+#endif
 					__m128i srcABCD = _mm_loadl_epi64((const __m128i*) src);
 					__m128i dstABCD = _mm_loadl_epi64((__m128i*) dst);
 					_mm_storel_epi64((__m128i *) dst, DarkenTwoPixels(srcABCD, dstABCD, DARKEN_PARAM_1, DARKEN_PARAM_2));
@@ -426,6 +527,8 @@ void Blitter_32bppSSE2::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomL
 void Blitter_32bppSSSE3::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
 #elif (SSE_VERSION == 4)
 void Blitter_32bppSSE4::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
+#elif (SSE_VERSION == 5)
+void Blitter_32bppAVX2::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
 #endif
 {
 	switch (mode) {
@@ -198,6 +198,16 @@ public:
 	 */
 	virtual const char *GetName() = 0;
 
+	/**
+	 * Get the version of the format this blitter encodes sprites in. It has to be
+	 * increased whenever the encoding changes, so sprites that were encoded and
+	 * stored by an older version are not used anymore.
+	 */
+	virtual uint GetSpriteFormatVersion()
+	{
+		return 1;
+	}
+
 	/**
 	 * Get how many bytes are needed to store a pixel.
 	 */
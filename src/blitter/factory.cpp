@@ -0,0 +1,51 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file factory.cpp Registration of the blitter factories. */
+
+#include "../stdafx.h"
+#include "factory.hpp"
+
+#include "../safeguards.h"
+
+/*
+ * The constructor and destructor are not inline, so they are never compiled
+ * with the instruction set flags of the translation unit of a blitter that
+ * may not be usable on the current computer, like the AVX2 blitter.
+ */
+
+/**
+ * Construct the blitter, and register it.
+ * @param name        The name of the blitter.
+ * @param description A longer description for the blitter.
+ * @param usable      Whether the blitter is usable (on the current computer). For example for disabling SSE blitters when the CPU can't handle them.
+ * @pre name != nullptr.
+ * @pre description != nullptr.
+ * @pre There is no blitter registered with this name.
+ */
+BlitterFactory::BlitterFactory(const char *name, const char *description, bool usable) :
+		name(name), description(description)
+{
+	if (usable) {
+		Blitters &blitters = GetBlitters();
+		assert(blitters.find(this->name) == blitters.end());
+		/*
+		 * Only add when the blitter is usable. Do not bail out or
+		 * do more special things since the blitters are always
+		 * instantiated upon start anyhow and freed upon shutdown.
+		 */
+		blitters.insert(Blitters::value_type(this->name, this));
+	} else {
+		DEBUG(driver, 1, "Not registering blitter %s as it is not usable", name);
+	}
+}
+
+BlitterFactory::~BlitterFactory()
+{
+	GetBlitters().erase(this->name);
+	if (GetBlitters().empty()) delete &GetBlitters();
+}
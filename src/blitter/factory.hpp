@@ -15,6 +15,7 @@
 #include "../string_func.h"
 #include "../core/string_compare_type.hpp"
 #include <map>
+#include <vector>
 
 
 /**
@@ -48,31 +49,7 @@ private:
 	}
 
 protected:
-	/**
-	 * Construct the blitter, and register it.
-	 * @param name        The name of the blitter.
-	 * @param description A longer description for the blitter.
-	 * @param usable      Whether the blitter is usable (on the current computer). For example for disabling SSE blitters when the CPU can't handle them.
-	 * @pre name != nullptr.
-	 * @pre description != nullptr.
-	 * @pre There is no blitter registered with this name.
-	 */
-	BlitterFactory(const char *name, const char *description, bool usable = true) :
-			name(name), description(description)
-	{
-		if (usable) {
-			Blitters &blitters = GetBlitters();
-			assert(blitters.find(this->name) == blitters.end());
-			/*
-			 * Only add when the blitter is usable. Do not bail out or
-			 * do more special things since the blitters are always
-			 * instantiated upon start anyhow and freed upon shutdown.
-			 */
-			blitters.insert(Blitters::value_type(this->name, this));
-		} else {
-			DEBUG(driver, 1, "Not registering blitter %s as it is not usable", name);
-		}
-	}
+	BlitterFactory(const char *name, const char *description, bool usable = true);
 
 	/**
 	 * Is the blitter usable with the current drivers and hardware config?
@@ -84,11 +61,7 @@ protected:
 	}
 
 public:
-	virtual ~BlitterFactory()
-	{
-		GetBlitters().erase(this->name);
-		if (GetBlitters().empty()) delete &GetBlitters();
-	}
+	virtual ~BlitterFactory();
 
 	/**
 	 * Find the requested blitter and return his class.
@@ -135,6 +108,19 @@ public:
 		return nullptr;
 	}
 
+	/**
+	 * Get all blitter factories whose blitters can be instantiated on this computer.
+	 * @return The usable blitter factories, sorted by name.
+	 */
+	static std::vector<BlitterFactory *> GetUsableBlitterFactories()
+	{
+		std::vector<BlitterFactory *> factories;
+		for (const auto &it : GetBlitters()) {
+			if (it.second->IsUsable()) factories.push_back(it.second);
+		}
+		return factories;
+	}
+
 	/**
 	 * Get the current active blitter (always set by calling SelectBlitter).
 	 */
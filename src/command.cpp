@@ -24,6 +24,7 @@
 #include "signal_func.h"
 #include "core/backup_type.hpp"
 #include "object_base.h"
+#include "pbs.h"
 
 #include "table/strings.h"
 
@@ -504,6 +505,8 @@ CommandCost DoCommand(TileIndex tile, uint32 p1, uint32 p2, DoCommandFlag flags,
 	 * themselves to the cost object at some point */
 	if (_docommand_recursive == 1) _cleared_object_areas.clear();
 	res = proc(tile, flags, p1, p2, text);
+	/* The command might have changed tracks or signals without touching reservations. */
+	InvalidateReservationCache();
 	if (res.Failed()) {
 error:
 		_docommand_recursive--;
@@ -724,6 +727,8 @@ CommandCost DoCommandPInternal(TileIndex tile, uint32 p1, uint32 p2, uint32 cmd,
 	BasePersistentStorageArray::SwitchMode(PSM_ENTER_COMMAND);
 	CommandCost res2 = proc(tile, flags | DC_EXEC, p1, p2, text);
 	BasePersistentStorageArray::SwitchMode(PSM_LEAVE_COMMAND);
+	/* The command might have changed tracks or signals without touching reservations. */
+	InvalidateReservationCache();
 
 	if (cmd_id == CMD_COMPANY_CTRL) {
 		cur_company.Trash();
@@ -2152,6 +2152,40 @@ DEF_CONSOLE_CMD(ConFramerate)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConFramerateWindows)
+{
+	extern void ConPrintWindowPaintTimes(); // framerate_gui.cpp
+
+	if (argc == 0) {
+		IConsoleHelp("Show the time spent painting each kind of window");
+		return true;
+	}
+
+	ConPrintWindowPaintTimes();
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConBenchmarkBlitters)
+{
+	extern void ConBenchmarkBlitters(uint duration); // framerate_gui.cpp
+
+	if (argc == 0) {
+		IConsoleHelp("Measure the drawing speed of all usable blitters. Usage: 'benchmark_blitters [<milliseconds per measurement>]'");
+		return true;
+	}
+
+	if (_network_dedicated) {
+		IConsoleError("Can not measure blitters on a dedicated server");
+		return false;
+	}
+
+	uint duration = 100;
+	if (argc > 2 || (argc == 2 && !GetArgumentInteger(&duration, argv[1]))) return false;
+
+	ConBenchmarkBlitters(std::max(duration, 1u));
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConFramerateWindow)
 {
 	extern void ShowFramerateWindow();
@@ -2456,6 +2490,8 @@ void IConsoleStdLibRegister()
 #endif
 	IConsoleCmdRegister("fps",     ConFramerate);
 	IConsoleCmdRegister("fps_wnd", ConFramerateWindow);
+	IConsoleCmdRegister("fps_windows", ConFramerateWindows);
+	IConsoleCmdRegister("benchmark_blitters", ConBenchmarkBlitters);
 
 	/* NewGRF development stuff */
 	IConsoleCmdRegister("reload_newgrfs",  ConNewGRFReload, ConHookNewGRFDeveloperTool);
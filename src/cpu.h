@@ -32,4 +32,10 @@ void ottd_cpuid(int info[4], int type);
  */
 bool HasCPUIDFlag(uint type, uint index, uint bit);
 
+/**
+ * Check whether the current CPU and operating system support AVX2 instructions.
+ * @return True iff AVX2 can be used.
+ */
+bool HasCPUAVX2();
+
 #endif /* CPU_H */
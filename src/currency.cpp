@@ -15,6 +15,7 @@
 #include "settings_type.h"
 #include "date_func.h"
 #include "string_type.h"
+#include "strings_func.h"
 
 #include "table/strings.h"
 
@@ -144,6 +145,7 @@ void CheckSwitchToEuro()
 			_currency_specs[_settings_game.locale.currency].to_euro != CF_ISEURO &&
 			_cur_year >= _currency_specs[_settings_game.locale.currency].to_euro) {
 		_settings_game.locale.currency = 2; // this is the index of euro above.
+		InvalidateStringCache();
 		AddNewsItem(STR_NEWS_EURO_INTRODUCTION, NT_ECONOMY, NF_NORMAL);
 	}
 }
@@ -160,6 +162,7 @@ void ResetCurrencies(bool preserve_custom)
 		if (preserve_custom && i == CURRENCY_CUSTOM) continue;
 		_currency_specs[i] = origin_currency_specs[i];
 	}
+	InvalidateStringCache();
 }
 
 /**
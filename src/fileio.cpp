@@ -13,8 +13,10 @@
 #include "fios.h"
 #include "string_func.h"
 #include "tar_type.h"
+#include "3rdparty/md5/md5.h"
 #ifdef _WIN32
 #include <windows.h>
+#include <io.h>
 # define access _taccess
 #elif defined(__HAIKU__)
 #include <Path.h>
@@ -23,6 +25,9 @@
 #include <unistd.h>
 #include <pwd.h>
 #endif
+#ifndef _WIN32
+#include <sys/file.h>
+#endif
 #include <sys/stat.h>
 #include <array>
 #include <sstream>
@@ -215,6 +220,30 @@ void FioOpenFile(int slot, const std::string &filename, Subdirectory subdir)
 	FioSeekToFile(slot, (size_t)pos);
 }
 
+/**
+ * Calculate the MD5 checksum of the file a slot reads from.
+ * For files inside a tar the checksum covers the whole tar.
+ * @param slot Slot of the file.
+ * @param[out] md5sum Checksum of the file.
+ */
+void FioCalcFileMD5(uint8 slot, uint8 md5sum[16])
+{
+	FILE *f = _fio.handles[slot];
+	assert(f != nullptr);
+
+	/* Restore the position afterwards, so reading from this slot is not disturbed. */
+	long pos = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	Md5 checksum;
+	uint8 buffer[1024];
+	size_t len;
+	while ((len = fread(buffer, 1, sizeof(buffer), f)) != 0) checksum.Append(buffer, len);
+	checksum.Finish(md5sum);
+
+	fseek(f, pos, SEEK_SET);
+}
+
 static const char * const _subdirs[] = {
 	"",
 	"save" PATHSEP,
@@ -485,6 +514,38 @@ FILE *FioFOpenFile(const std::string &filename, const char *mode, Subdirectory s
 	return f;
 }
 
+/**
+ * Lock an opened file for exclusive use by this process, without waiting for
+ * other processes. The lock is released when the file is closed.
+ * @param f The file to lock.
+ * @return True if the lock was taken, false if the file is in use elsewhere.
+ */
+bool FioLockFile(FILE *f)
+{
+#ifdef _WIN32
+	OVERLAPPED overlapped = {};
+	return LockFileEx((HANDLE)_get_osfhandle(_fileno(f)), LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, MAXDWORD, MAXDWORD, &overlapped) != 0;
+#else
+	return flock(fileno(f), LOCK_EX | LOCK_NB) == 0;
+#endif
+}
+
+/**
+ * Truncate an opened file.
+ * @param f The file to truncate.
+ * @param size The new size of the file.
+ * @return True if the file was truncated.
+ */
+bool FioTruncateFile(FILE *f, long size)
+{
+	if (fflush(f) != 0) return false;
+#ifdef _WIN32
+	return _chsize(_fileno(f), size) == 0;
+#else
+	return ftruncate(fileno(f), size) == 0;
+#endif
+}
+
 /**
  * Create a directory with the given name
  * If the parent directory does not exist, it will try to create that as well.
@@ -23,6 +23,7 @@ uint16 FioReadWord();
 uint32 FioReadDword();
 void FioCloseAll();
 void FioOpenFile(int slot, const std::string &filename, Subdirectory subdir);
+void FioCalcFileMD5(uint8 slot, uint8 md5sum[16]);
 void FioReadBlock(void *ptr, size_t size);
 void FioSkipBytes(int n);
 
@@ -38,6 +39,8 @@ bool IsValidSearchPath(Searchpath sp);
 
 void FioFCloseFile(FILE *f);
 FILE *FioFOpenFile(const std::string &filename, const char *mode, Subdirectory subdir, size_t *filesize = nullptr);
+bool FioLockFile(FILE *f);
+bool FioTruncateFile(FILE *f, long size);
 bool FioCheckFileExists(const std::string &filename, Subdirectory subdir);
 std::string FioFindFullPath(Subdirectory subdir, const char *filename);
 std::string FioGetDirectory(Searchpath sp, Subdirectory subdir);
@@ -237,16 +237,12 @@ void TrueTypeFontCache::ClearFontCache()
 	for (int i = 0; i < 256; i++) {
 		if (this->glyph_to_sprite[i] == nullptr) continue;
 
-		for (int j = 0; j < 256; j++) {
-			if (this->glyph_to_sprite[i][j].duplicate) continue;
-			free(this->glyph_to_sprite[i][j].sprite);
-		}
-
 		free(this->glyph_to_sprite[i]);
 	}
 
 	free(this->glyph_to_sprite);
 	this->glyph_to_sprite = nullptr;
+	this->atlas.Clear();
 
 	Layouter::ResetFontCache(this->fs);
 }
@@ -277,6 +273,67 @@ void TrueTypeFontCache::SetGlyphPtr(GlyphID key, const GlyphEntry *glyph, bool d
 	this->glyph_to_sprite[GB(key, 8, 8)][GB(key, 0, 8)].duplicate = duplicate;
 }
 
+/**
+ * Get memory from the atlas.
+ * @param size The number of bytes to allocate.
+ * @return The allocated memory; it stays valid until the atlas is cleared.
+ */
+void *GlyphAtlas::Allocate(size_t size)
+{
+	/* Keep the sprites aligned like malloc would. */
+	size = Align(size, 16);
+
+	if (size > PAGE_SIZE / 4) {
+		/* Large glyphs get a page of their own, so they do not waste the rest of the current page. */
+		byte *page = new byte[size];
+		this->pages.emplace(this->pages.empty() ? this->pages.end() : this->pages.end() - 1, page);
+		return page;
+	}
+
+	if (this->used + size > PAGE_SIZE) {
+		this->pages.emplace_back(new byte[PAGE_SIZE]);
+		this->used = 0;
+	}
+
+	void *result = this->pages.back().get() + this->used;
+	this->used += size;
+	return result;
+}
+
+/**
+ * Free all memory of the atlas.
+ */
+void GlyphAtlas::Clear()
+{
+	this->pages.clear();
+	this->used = PAGE_SIZE;
+}
+
+/** The atlas that #GlyphAtlasAlloc allocates from. */
+static GlyphAtlas *_glyph_atlas = nullptr;
+
+/**
+ * Sprite allocator for the glyphs of a TrueType font cache.
+ * @param size The number of bytes to allocate.
+ * @return The allocated memory.
+ */
+static void *GlyphAtlasAlloc(size_t size)
+{
+	return _glyph_atlas->Allocate(size);
+}
+
+/**
+ * Encode a rendered glyph for the current blitter and store it in the atlas of the font cache.
+ * @param sprite The rendered glyph.
+ * @return The encoded sprite.
+ */
+Sprite *TrueTypeFontCache::EncodeGlyph(const SpriteLoader::Sprite *sprite)
+{
+	_glyph_atlas = &this->atlas;
+	Sprite *result = BlitterFactory::GetCurrentBlitter()->Encode(sprite, GlyphAtlasAlloc);
+	_glyph_atlas = nullptr;
+	return result;
+}
 
 /* Check if a glyph should be rendered with anti-aliasing. */
 static bool GetFontAAState(FontSize size, bool check_blitter = true)
@@ -350,7 +407,7 @@ const Sprite *TrueTypeFontCache::GetGlyph(GlyphID key)
 				builtin_questionmark_data
 			};
 
-			Sprite *spr = BlitterFactory::GetCurrentBlitter()->Encode(&builtin_questionmark, SimpleSpriteAlloc);
+			Sprite *spr = this->EncodeGlyph(&builtin_questionmark);
 			assert(spr != nullptr);
 			GlyphEntry new_glyph;
 			new_glyph.sprite = spr;
@@ -638,7 +695,7 @@ const Sprite *FreeTypeFontCache::InternalGetGlyph(GlyphID key, bool aa)
 	}
 
 	GlyphEntry new_glyph;
-	new_glyph.sprite = BlitterFactory::GetCurrentBlitter()->Encode(&sprite, SimpleSpriteAlloc);
+	new_glyph.sprite = this->EncodeGlyph(&sprite);
 	new_glyph.width  = slot->advance.x >> 6;
 
 	this->SetGlyphPtr(key, &new_glyph);
@@ -12,6 +12,9 @@
 
 #include "core/smallmap_type.hpp"
 #include "fontcache.h"
+#include "spriteloader/spriteloader.hpp"
+#include <memory>
+#include <vector>
 
 
 static const int MAX_FONT_SIZE = 72; ///< Maximum font size.
@@ -19,6 +22,21 @@ static const int MAX_FONT_SIZE = 72; ///< Maximum font size.
 static const byte FACE_COLOUR = 1;
 static const byte SHADOW_COLOUR = 2;
 
+/**
+ * Memory for the encoded glyph sprites of a font cache. The sprites are packed
+ * into large pages instead of being allocated one by one, so the glyphs of a
+ * font lie close together and are all freed at once when the cache is cleared.
+ */
+struct GlyphAtlas {
+	static constexpr size_t PAGE_SIZE = 64 * 1024; ///< Size of a page of the atlas.
+
+	std::vector<std::unique_ptr<byte[]>> pages; ///< The allocated pages; the last one is being filled.
+	size_t used = PAGE_SIZE;                    ///< Number of bytes used of the last page.
+
+	void *Allocate(size_t size);
+	void Clear();
+};
+
 /** Font cache for fonts that are based on a TrueType font. */
 class TrueTypeFontCache : public FontCache {
 protected:
@@ -53,8 +71,11 @@ protected:
 	 */
 	GlyphEntry **glyph_to_sprite;
 
+	GlyphAtlas atlas; ///< Memory of the sprites in #glyph_to_sprite.
+
 	GlyphEntry *GetGlyphPtr(GlyphID key);
 	void SetGlyphPtr(GlyphID key, const GlyphEntry *glyph, bool duplicate = false);
+	Sprite *EncodeGlyph(const SpriteLoader::Sprite *sprite);
 
 	virtual const void *InternalGetFontTable(uint32 tag, size_t &length) = 0;
 	virtual const Sprite *InternalGetGlyph(GlyphID key, bool aa) = 0;
@@ -23,6 +23,12 @@
 #include "ai/ai_instance.hpp"
 #include "game/game.hpp"
 #include "game/game_instance.hpp"
+#include "spritecache.h"
+#include "gfx_layout.h"
+#include "settings_type.h"
+#include "zoom_func.h"
+#include "blitter/factory.hpp"
+#include "network/network.h"
 
 #include "widgets/framerate_widget.h"
 #include "safeguards.h"
@@ -212,6 +218,30 @@ namespace {
 		PerformanceData(1),                     // PFE_AI14
 	};
 
+	/** Number of window classes painting time is recorded for */
+	const uint NUM_WINDOW_PAINT_CLASSES = WC_SCREENSHOT + 1;
+	/** Number of drawing frames painting time is summed over before the averages are updated */
+	const int WINDOW_PAINT_PERIOD = 32;
+
+	/** Time spent painting the windows of one window class */
+	struct WindowPaintData {
+		/** Name of the window class, taken from the settings key of its windows */
+		const char *name;
+		/** Time spent painting in the current period */
+		TimingMeasurement acc_duration;
+		/** Number of paint calls in the current period */
+		uint acc_paints;
+		/** Average painting time per drawing frame over the last complete period, in milliseconds */
+		double duration_ms;
+		/** Average number of paint calls per drawing frame over the last complete period */
+		double paints;
+	};
+
+	/** Painting time of all window classes */
+	WindowPaintData _window_paint_data[NUM_WINDOW_PAINT_CLASSES];
+	/** Number of drawing frames in the current painting time period */
+	int _window_paint_frames = 0;
+
 }
 
 
@@ -308,6 +338,84 @@ void PerformanceAccumulator::Reset(PerformanceElement elem)
 }
 
 
+/**
+ * Begin measuring the painting of a window.
+ * @param w The window that is going to be painted
+ */
+WindowPaintAccumulator::WindowPaintAccumulator(const Window *w)
+{
+	this->window_class = w->window_class;
+	this->start_time = GetPerformanceTimer();
+
+	if (this->window_class < NUM_WINDOW_PAINT_CLASSES && _window_paint_data[this->window_class].name == nullptr) {
+		_window_paint_data[this->window_class].name = (this->window_class == WC_MAIN_WINDOW) ? "main_window" : w->window_desc->ini_key;
+	}
+}
+
+/** Finish measuring the painting of a window and add it to its window class. */
+WindowPaintAccumulator::~WindowPaintAccumulator()
+{
+	if (this->window_class >= NUM_WINDOW_PAINT_CLASSES) return;
+
+	WindowPaintData &data = _window_paint_data[this->window_class];
+	data.acc_duration += GetPerformanceTimer() - this->start_time;
+	data.acc_paints++;
+}
+
+/**
+ * Begin a new drawing frame for the window painting measurements.
+ * Every #WINDOW_PAINT_PERIOD frames the averages per window class are updated.
+ * @note This function must be called once per drawing frame.
+ */
+/* static */ void WindowPaintAccumulator::Reset()
+{
+	if (++_window_paint_frames < WINDOW_PAINT_PERIOD) return;
+
+	for (WindowPaintData &data : _window_paint_data) {
+		data.duration_ms = (double)data.acc_duration * 1000 / TIMESTAMP_PRECISION / _window_paint_frames;
+		data.paints = (double)data.acc_paints / _window_paint_frames;
+		data.acc_duration = 0;
+		data.acc_paints = 0;
+	}
+	_window_paint_frames = 0;
+}
+
+/**
+ * Get a printable name of a window class for the painting time measurements.
+ * @param buf  Buffer to write the name to.
+ * @param last Last character of the buffer.
+ * @param cls  The window class.
+ * @return Pointer to the name in \a buf.
+ */
+static const char *GetWindowPaintName(char *buf, const char *last, uint cls)
+{
+	const char *name = _window_paint_data[cls].name;
+	if (name != nullptr) {
+		strecpy(buf, name, last);
+	} else {
+		seprintf(buf, last, "window class %u", cls);
+	}
+	return buf;
+}
+
+/**
+ * Get the window class that took the most time to paint in the last measurement period.
+ * @return The window class, or #WC_INVALID if no window was painted.
+ */
+static WindowClass GetSlowestWindowClass()
+{
+	WindowClass slowest = WC_INVALID;
+	double slowest_ms = 0;
+	for (uint cls = 0; cls < NUM_WINDOW_PAINT_CLASSES; cls++) {
+		if (_window_paint_data[cls].duration_ms > slowest_ms) {
+			slowest = (WindowClass)cls;
+			slowest_ms = _window_paint_data[cls].duration_ms;
+		}
+	}
+	return slowest;
+}
+
+
 void ShowFrametimeGraphWindow(PerformanceElement elem);
 
 
@@ -376,6 +484,12 @@ static const NWidgetPart _framerate_window_widgets[] = {
 					EndContainer(),
 				EndContainer(),
 				NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_INFO_DATA_POINTS), SetDataTip(STR_FRAMERATE_DATA_POINTS, 0x0),
+				NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_INFO_SPRITE_CACHE_SIZE), SetDataTip(STR_FRAMERATE_SPRITE_CACHE_SIZE, STR_FRAMERATE_SPRITE_CACHE_TOOLTIP),
+				NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_INFO_SPRITE_CACHE_USE), SetDataTip(STR_FRAMERATE_SPRITE_CACHE_USE, STR_FRAMERATE_SPRITE_CACHE_TOOLTIP),
+				NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_INFO_SCREEN_REDRAW), SetDataTip(STR_FRAMERATE_SCREEN_REDRAW, STR_FRAMERATE_SCREEN_REDRAW_TOOLTIP),
+				NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_INFO_LINE_CACHE), SetDataTip(STR_FRAMERATE_LINE_CACHE, STR_FRAMERATE_LINE_CACHE_TOOLTIP),
+				NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_INFO_STRING_CACHE), SetDataTip(STR_FRAMERATE_STRING_CACHE, STR_FRAMERATE_STRING_CACHE_TOOLTIP),
+				NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_INFO_SLOWEST_WINDOW), SetDataTip(STR_FRAMERATE_SLOWEST_WINDOW, STR_FRAMERATE_SLOWEST_WINDOW_TOOLTIP),
 			EndContainer(),
 		EndContainer(),
 		NWidget(NWID_VERTICAL),
@@ -424,9 +538,22 @@ struct FramerateWindow : Window {
 	CachedDecimal speed_gameloop;           ///< cached game loop speed factor
 	CachedDecimal times_shortterm[PFE_MAX]; ///< cached short term average times
 	CachedDecimal times_longterm[PFE_MAX];  ///< cached long term average times
+	SpriteCacheStats sprite_cache;          ///< cached sprite cache statistics
+	DirtyRedrawStats screen_redraw;         ///< cached amount of the screen redrawn in the last frame
+	LineCacheStats line_cache;              ///< cached text layout cache statistics
+	StringCacheStats string_cache;          ///< cached formatted string cache statistics
+	WindowClass slowest_window;             ///< cached window class that takes the most time to paint
+	char slowest_window_name[64];           ///< cached name of the window class that takes the most time to paint
 
 	static constexpr int VSPACING = 3;          ///< space between column heading and values
 	static constexpr int MIN_ELEMENTS = 5;      ///< smallest number of elements to display
+	static constexpr uint COUNTER_DIGITS = 18;  ///< number of digits shown for cache counters, they are printed as signed 64 bit numbers
+
+	/** Clamp a cache counter to the number of digits reserved for it. */
+	static inline uint64 ClampCounter(uint64 counter)
+	{
+		return std::min<uint64>(counter, 999999999999999999ULL);
+	}
 
 	FramerateWindow(WindowDesc *desc, WindowNumber number) : Window(desc)
 	{
@@ -468,6 +595,16 @@ struct FramerateWindow : Window {
 		if (this->small) return; // in small mode, this is everything needed
 
 		this->rate_drawing.SetRate(_pf_data[PFE_DRAWING].GetRate(), _settings_client.gui.refresh_rate);
+		this->sprite_cache = GetSpriteCacheStats();
+		this->screen_redraw = GetDirtyRedrawStats();
+		this->line_cache = Layouter::GetLineCacheStats();
+		this->string_cache = GetStringCacheStats();
+		this->slowest_window = GetSlowestWindowClass();
+		if (this->slowest_window == WC_INVALID) {
+			strecpy(this->slowest_window_name, "-", lastof(this->slowest_window_name));
+		} else {
+			GetWindowPaintName(this->slowest_window_name, lastof(this->slowest_window_name), this->slowest_window);
+		}
 
 		int new_active = 0;
 		for (PerformanceElement e = PFE_FIRST; e < PFE_MAX; e++) {
@@ -519,6 +656,36 @@ struct FramerateWindow : Window {
 			case WID_FRW_INFO_DATA_POINTS:
 				SetDParam(0, NUM_FRAMERATE_POINTS);
 				break;
+			case WID_FRW_INFO_SPRITE_CACHE_SIZE:
+				SetDParam(0, this->sprite_cache.used);
+				SetDParam(1, this->sprite_cache.budget);
+				break;
+			case WID_FRW_INFO_SPRITE_CACHE_USE:
+				SetDParam(0, ClampCounter(this->sprite_cache.hits));
+				SetDParam(1, ClampCounter(this->sprite_cache.misses));
+				SetDParam(2, ClampCounter(this->sprite_cache.evictions));
+				break;
+			case WID_FRW_INFO_SCREEN_REDRAW:
+				SetDParam(0, this->screen_redraw.pixels);
+				SetDParam(1, this->screen_redraw.rects);
+				break;
+			case WID_FRW_INFO_LINE_CACHE:
+				SetDParam(0, this->line_cache.size);
+				SetDParam(1, ClampCounter(this->line_cache.hits));
+				SetDParam(2, ClampCounter(this->line_cache.misses));
+				SetDParam(3, ClampCounter(this->line_cache.evictions));
+				break;
+			case WID_FRW_INFO_STRING_CACHE:
+				SetDParam(0, this->string_cache.size);
+				SetDParam(1, ClampCounter(this->string_cache.hits));
+				SetDParam(2, ClampCounter(this->string_cache.misses));
+				SetDParam(3, ClampCounter(this->string_cache.uncacheable));
+				break;
+			case WID_FRW_INFO_SLOWEST_WINDOW:
+				SetDParamStr(0, this->slowest_window_name);
+				SetDParam(1, this->slowest_window == WC_INVALID ? 0 : (int64)(_window_paint_data[this->slowest_window].duration_ms * 100));
+				SetDParam(2, 2);
+				break;
 		}
 	}
 
@@ -542,6 +709,42 @@ struct FramerateWindow : Window {
 				SetDParam(1, 2);
 				*size = GetStringBoundingBox(STR_FRAMERATE_SPEED_FACTOR);
 				break;
+			case WID_FRW_INFO_SPRITE_CACHE_SIZE:
+				SetDParam(0, 999999999);
+				SetDParam(1, 999999999);
+				*size = GetStringBoundingBox(STR_FRAMERATE_SPRITE_CACHE_SIZE);
+				break;
+			case WID_FRW_INFO_SPRITE_CACHE_USE:
+				SetDParamMaxDigits(0, COUNTER_DIGITS);
+				SetDParamMaxDigits(1, COUNTER_DIGITS);
+				SetDParamMaxDigits(2, COUNTER_DIGITS);
+				*size = GetStringBoundingBox(STR_FRAMERATE_SPRITE_CACHE_USE);
+				break;
+			case WID_FRW_INFO_SCREEN_REDRAW:
+				SetDParamMaxDigits(0, 9);
+				SetDParamMaxDigits(1, 5);
+				*size = GetStringBoundingBox(STR_FRAMERATE_SCREEN_REDRAW);
+				break;
+			case WID_FRW_INFO_LINE_CACHE:
+				SetDParamMaxDigits(0, 5);
+				SetDParamMaxDigits(1, COUNTER_DIGITS);
+				SetDParamMaxDigits(2, COUNTER_DIGITS);
+				SetDParamMaxDigits(3, COUNTER_DIGITS);
+				*size = GetStringBoundingBox(STR_FRAMERATE_LINE_CACHE);
+				break;
+			case WID_FRW_INFO_STRING_CACHE:
+				SetDParamMaxDigits(0, 5);
+				SetDParamMaxDigits(1, COUNTER_DIGITS);
+				SetDParamMaxDigits(2, COUNTER_DIGITS);
+				SetDParamMaxDigits(3, COUNTER_DIGITS);
+				*size = GetStringBoundingBox(STR_FRAMERATE_STRING_CACHE);
+				break;
+			case WID_FRW_INFO_SLOWEST_WINDOW:
+				SetDParamStr(0, "build_vehicle_aircraft");
+				SetDParamMaxDigits(1, 6);
+				SetDParam(2, 2);
+				*size = GetStringBoundingBox(STR_FRAMERATE_SLOWEST_WINDOW);
+				break;
 
 			case WID_FRW_TIMES_NAMES: {
 				size->width = 0;
@@ -1075,7 +1278,137 @@ void ConPrintFramerate()
 		printed_anything = true;
 	}
 
+	/* A dedicated server never draws anything. */
+	DirtyRedrawStats redraw = GetDirtyRedrawStats();
+	if (!_network_dedicated && redraw.rects > 0) {
+		IConsolePrintF(TC_LIGHT_BLUE, "Last screen redraw: " OTTD_PRINTF64 " pixels in %u rectangles", (int64)redraw.pixels, redraw.rects);
+		printed_anything = true;
+	}
+
 	if (!printed_anything) {
 		IConsoleWarning("No performance measurements have been taken yet");
 	}
 }
+
+/**
+ * Print the time spent painting each window class to the console, most expensive first.
+ */
+void ConPrintWindowPaintTimes()
+{
+	std::vector<uint> classes;
+	for (uint cls = 0; cls < NUM_WINDOW_PAINT_CLASSES; cls++) {
+		if (_window_paint_data[cls].paints > 0) classes.push_back(cls);
+	}
+
+	if (classes.empty()) {
+		IConsoleWarning("No windows have been painted yet");
+		return;
+	}
+
+	std::sort(classes.begin(), classes.end(), [](uint a, uint b) { return _window_paint_data[a].duration_ms > _window_paint_data[b].duration_ms; });
+
+	IConsolePrintF(TC_SILVER, "Average per drawing frame over the last %d frames:", WINDOW_PAINT_PERIOD);
+	char name[64];
+	for (uint cls : classes) {
+		const WindowPaintData &data = _window_paint_data[cls];
+		IConsolePrintF(TC_LIGHT_BLUE, "%s: %.3fms in %.2f paints", GetWindowPaintName(name, lastof(name), cls), data.duration_ms, data.paints);
+	}
+}
+
+/**
+ * Measure how fast every usable blitter draws sprites and print the results to the console.
+ * A fixed set of base set sprites is drawn into an off-screen buffer at each zoom level
+ * sprites are encoded for, once for every blitter mode, and the speed is given in Mpixels/s.
+ * @param duration Minimum time in milliseconds to spend on each measurement.
+ */
+void ConBenchmarkBlitters(uint duration)
+{
+	/** Ground tiles, buildings, a vehicle and interface sprites of various sizes and transparency. */
+	static const SpriteID BENCHMARK_SPRITES[] = {
+		SPR_FLAT_GRASS_TILE, SPR_FLAT_WATER_TILE, SPR_RAIL_TRACK_X, SPR_ROAD_Y, SPR_TRANSMITTER,
+		SPR_LIGHTHOUSE, SPR_STATUE_COMPANY, SPR_VEH_BUS_SW_VIEW, SPR_IMG_QUERY, SPR_COMPANY_ICON,
+	};
+
+	/** The measured blitter modes with the recolour sprite used as their remap table. */
+	static const struct {
+		BlitterMode mode;
+		PaletteID pal;
+		const char *name;
+	} BENCHMARK_MODES[] = {
+		{ BM_NORMAL,       PALETTE_RECOLOUR_START, "normal" },
+		{ BM_COLOUR_REMAP, PALETTE_TO_RED,         "remap" },
+		{ BM_TRANSPARENT,  PALETTE_TO_TRANSPARENT, "transparent" },
+		{ BM_CRASH_REMAP,  PALETTE_CRASH,          "crash" },
+		{ BM_BLACK_REMAP,  PALETTE_ALL_BLACK,      "black" },
+	};
+
+	const ZoomLevel zoom_min = (ZoomLevel)_settings_client.gui.zoom_min;
+	const ZoomLevel zoom_max = (ZoomLevel)_settings_client.gui.zoom_max;
+
+	IConsolePrintF(TC_SILVER, "Blitter speed in Mpixels/s, for zoom levels %d (most zoomed in) to %d", zoom_min, zoom_max);
+
+	for (BlitterFactory *factory : BlitterFactory::GetUsableBlitterFactories()) {
+		Blitter *blitter = factory->CreateInstance();
+
+		/* Animated blitters keep a buffer that mirrors the screen, so they cannot draw off-screen. */
+		if (blitter->GetScreenDepth() == 0 || blitter->UsePaletteAnimation() == Blitter::PALETTE_ANIMATION_BLITTER || blitter->NeedsAnimationBuffer()) {
+			IConsolePrintF(TC_LIGHT_BROWN, "%s: skipped, it can only draw to the screen", factory->GetName().c_str());
+			delete blitter;
+			continue;
+		}
+
+		/* Encode the sprites in the format of this blitter, and make the buffer fit the largest of them. */
+		std::vector<Sprite *> sprites;
+		int buf_width = 1;
+		int buf_height = 1;
+		for (SpriteID id : BENCHMARK_SPRITES) {
+			Sprite *sprite = (Sprite *)GetRawSprite(id, ST_NORMAL, SimpleSpriteAlloc, blitter);
+			sprites.push_back(sprite);
+			buf_width = std::max(buf_width, UnScaleByZoom(sprite->width, zoom_min));
+			buf_height = std::max(buf_height, UnScaleByZoom(sprite->height, zoom_min));
+		}
+		std::vector<byte> buffer((size_t)buf_width * buf_height * blitter->GetScreenDepth() / 8);
+
+		IConsolePrintF(TC_GREEN, "%s:", factory->GetName().c_str());
+
+		for (ZoomLevel zoom = zoom_min; zoom <= zoom_max; zoom++) {
+			char buf[256];
+			char *p = buf;
+			p += seprintf(p, lastof(buf), "  zoom %d:", zoom);
+
+			for (const auto &m : BENCHMARK_MODES) {
+				Blitter::BlitterParams bp;
+				bp.remap = GetNonSprite(m.pal, ST_RECOLOUR) + 1;
+				bp.skip_left = 0;
+				bp.skip_top = 0;
+				bp.left = 0;
+				bp.top = 0;
+				bp.dst = buffer.data();
+				bp.pitch = buf_width;
+
+				uint64 pixels = 0;
+				TimingMeasurement start = GetPerformanceTimer();
+				TimingMeasurement elapsed;
+				do {
+					for (const Sprite *sprite : sprites) {
+						bp.sprite = sprite->data;
+						bp.sprite_width = sprite->width;
+						bp.sprite_height = sprite->height;
+						bp.width = UnScaleByZoom(sprite->width, zoom);
+						bp.height = UnScaleByZoom(sprite->height, zoom);
+						blitter->Draw(&bp, m.mode, zoom);
+						pixels += bp.width * bp.height;
+					}
+					elapsed = GetPerformanceTimer() - start;
+				} while (elapsed < (TimingMeasurement)duration * TIMESTAMP_PRECISION / 1000);
+
+				p += seprintf(p, lastof(buf), "  %s %.1f", m.name, (double)pixels * TIMESTAMP_PRECISION / 1000000 / elapsed);
+			}
+
+			IConsolePrint(TC_LIGHT_BLUE, buf);
+		}
+
+		for (Sprite *sprite : sprites) free(sprite);
+		delete blitter;
+	}
+}
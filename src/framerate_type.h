@@ -37,6 +37,7 @@
 
 #include "stdafx.h"
 #include "core/enum_type.hpp"
+#include "window_type.h"
 
 /**
  * Elements of game performance that can be measured.
@@ -120,6 +121,20 @@ public:
 	static void Reset(PerformanceElement elem);
 };
 
+/**
+ * RAII class for measuring the time spent painting a window.
+ * The measurements are summed per window class, so the cost of each kind of window can be compared.
+ * Call Reset once at the beginning of every drawing frame.
+ */
+class WindowPaintAccumulator {
+	WindowClass window_class;
+	TimingMeasurement start_time;
+public:
+	WindowPaintAccumulator(const Window *w);
+	~WindowPaintAccumulator();
+	static void Reset();
+};
+
 void ShowFramerateWindow();
 
 #endif /* FRAMERATE_TYPE_H */
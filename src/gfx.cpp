@@ -76,9 +76,13 @@ static byte _string_colourremap[3]; ///< Recoloursprite for stringdrawing. The g
 
 static const uint DIRTY_BLOCK_HEIGHT   = 8;
 static const uint DIRTY_BLOCK_WIDTH    = 64;
+static const uint DIRTY_BLOCKS_PER_WORD = 32; ///< Number of dirty blocks tracked by each word of #_dirty_blocks.
 
-static uint _dirty_bytes_per_line = 0;
-static byte *_dirty_blocks = nullptr;
+static uint _dirty_block_columns = 0;  ///< Number of dirty blocks in a line of the screen.
+static uint _dirty_block_rows = 0;     ///< Number of lines of dirty blocks of the screen.
+static uint _dirty_words_per_line = 0; ///< Number of words of #_dirty_blocks for each line of dirty blocks.
+static uint32 *_dirty_blocks = nullptr; ///< For each line of dirty blocks a bitset with a bit per block, set when the block needs to be redrawn.
+static DirtyRedrawStats _dirty_redraw_stats = {}; ///< Amount of the screen redrawn by the last #DrawDirtyBlocks.
 extern uint _dirty_block_colour;
 
 void GfxScroll(int left, int top, int width, int height, int xo, int yo)
@@ -1335,8 +1339,11 @@ void GetBroadestDigit(uint *front, uint *next, FontSize size)
 
 void ScreenSizeChanged()
 {
-	_dirty_bytes_per_line = CeilDiv(_screen.width, DIRTY_BLOCK_WIDTH);
-	_dirty_blocks = ReallocT<byte>(_dirty_blocks, _dirty_bytes_per_line * CeilDiv(_screen.height, DIRTY_BLOCK_HEIGHT));
+	_dirty_block_columns = CeilDiv(_screen.width, DIRTY_BLOCK_WIDTH);
+	_dirty_block_rows = CeilDiv(_screen.height, DIRTY_BLOCK_HEIGHT);
+	_dirty_words_per_line = CeilDiv(_dirty_block_columns, DIRTY_BLOCKS_PER_WORD);
+	_dirty_blocks = ReallocT<uint32>(_dirty_blocks, _dirty_words_per_line * _dirty_block_rows);
+	MemSetT(_dirty_blocks, 0, _dirty_words_per_line * _dirty_block_rows);
 
 	/* check the dirty rect */
 	if (_invalid_rect.right >= _screen.width) _invalid_rect.right = _screen.width;
@@ -1455,90 +1462,138 @@ void RedrawScreenRect(int left, int top, int right, int bottom)
 	VideoDriver::GetInstance()->MakeDirty(left, top, right - left, bottom - top);
 }
 
+/**
+ * Get the bits of a word of a line of #_dirty_blocks that lie within a range of dirty blocks.
+ * @param word  The word in the line.
+ * @param first The first dirty block of the range.
+ * @param last  The dirty block just after the range.
+ * @return The bits of the word within the range.
+ */
+static inline uint32 GetDirtyBlockMask(uint word, uint first, uint last)
+{
+	uint32 mask = UINT32_MAX;
+	if (first > word * DIRTY_BLOCKS_PER_WORD) mask &= UINT32_MAX << (first % DIRTY_BLOCKS_PER_WORD);
+	if (last < (word + 1) * DIRTY_BLOCKS_PER_WORD) mask &= ~(UINT32_MAX << (last % DIRTY_BLOCKS_PER_WORD));
+	return mask;
+}
+
+/**
+ * Check whether all blocks in a range of a line of dirty blocks are dirty.
+ * @param line  The line of dirty blocks.
+ * @param first The first dirty block of the range.
+ * @param last  The dirty block just after the range.
+ * @return True iff every block in the range is dirty.
+ */
+static bool IsDirtyBlockRange(const uint32 *line, uint first, uint last)
+{
+	for (uint w = first / DIRTY_BLOCKS_PER_WORD; w <= (last - 1) / DIRTY_BLOCKS_PER_WORD; w++) {
+		uint32 mask = GetDirtyBlockMask(w, first, last);
+		if ((line[w] & mask) != mask) return false;
+	}
+	return true;
+}
+
+/**
+ * Mark or unmark a range of a line of dirty blocks.
+ * @param line  The line of dirty blocks.
+ * @param first The first dirty block of the range.
+ * @param last  The dirty block just after the range.
+ * @param dirty Whether the blocks become dirty or clean.
+ */
+static void SetDirtyBlockRange(uint32 *line, uint first, uint last, bool dirty)
+{
+	for (uint w = first / DIRTY_BLOCKS_PER_WORD; w <= (last - 1) / DIRTY_BLOCKS_PER_WORD; w++) {
+		uint32 mask = GetDirtyBlockMask(w, first, last);
+		if (dirty) {
+			line[w] |= mask;
+		} else {
+			line[w] &= ~mask;
+		}
+	}
+}
+
 /**
  * Repaints the rectangle blocks which are marked as 'dirty'.
  *
+ * Every dirty block starts a rectangle that is grown in two ways: first
+ * along the run of dirty blocks to its right and then downwards, or first
+ * downwards and then to the right. The larger of both is redrawn, so
+ * neither wide nor tall dirty areas get split into many small rectangles.
+ *
  * @see AddDirtyBlock
  *
  * @ingroup dirty
  */
 void DrawDirtyBlocks()
 {
-	byte *b = _dirty_blocks;
-	const int w = Align(_screen.width,  DIRTY_BLOCK_WIDTH);
-	const int h = Align(_screen.height, DIRTY_BLOCK_HEIGHT);
-	int x;
-	int y;
+	_dirty_redraw_stats = {};
+
+	/* Only the lines within the invalid rectangle can contain dirty blocks.
+	 * Redrawing may extend the rectangle, so its bottom is checked for every line. */
+	for (uint row = _invalid_rect.top / DIRTY_BLOCK_HEIGHT; row < _dirty_block_rows && (int)(row * DIRTY_BLOCK_HEIGHT) < _invalid_rect.bottom; row++) {
+		uint32 *line = _dirty_blocks + row * _dirty_words_per_line;
+
+		for (uint w = 0; w < _dirty_words_per_line; w++) {
+			while (line[w] != 0) {
+				uint first = w * DIRTY_BLOCKS_PER_WORD + FindFirstBit(line[w]);
+
+				/* Rectangle growing to the right first. */
+				uint run_last = first + 1;
+				while (run_last < _dirty_block_columns && HasBit(line[run_last / DIRTY_BLOCKS_PER_WORD], run_last % DIRTY_BLOCKS_PER_WORD)) run_last++;
+				uint run_bottom = row + 1;
+				while (run_bottom < _dirty_block_rows && IsDirtyBlockRange(line + (run_bottom - row) * _dirty_words_per_line, first, run_last)) run_bottom++;
+
+				/* Rectangle growing downwards first; it can never be wider than the run. */
+				uint col_bottom = row + 1;
+				while (col_bottom < _dirty_block_rows && HasBit(line[(col_bottom - row) * _dirty_words_per_line + w], first % DIRTY_BLOCKS_PER_WORD)) col_bottom++;
+				uint col_last = first + 1;
+				for (; col_last < run_last; col_last++) {
+					uint r = row + 1;
+					while (r < col_bottom && HasBit(line[(r - row) * _dirty_words_per_line + col_last / DIRTY_BLOCKS_PER_WORD], col_last % DIRTY_BLOCKS_PER_WORD)) r++;
+					if (r != col_bottom) break;
+				}
 
-	y = 0;
-	do {
-		x = 0;
-		do {
-			if (*b != 0) {
-				int left;
-				int top;
-				int right = x + DIRTY_BLOCK_WIDTH;
-				int bottom = y;
-				byte *p = b;
-				int h2;
-
-				/* First try coalescing downwards */
-				do {
-					*p = 0;
-					p += _dirty_bytes_per_line;
-					bottom += DIRTY_BLOCK_HEIGHT;
-				} while (bottom != h && *p != 0);
-
-				/* Try coalescing to the right too. */
-				h2 = (bottom - y) / DIRTY_BLOCK_HEIGHT;
-				assert(h2 > 0);
-				p = b;
-
-				while (right != w) {
-					byte *p2 = ++p;
-					int h = h2;
-					/* Check if a full line of dirty flags is set. */
-					do {
-						if (!*p2) goto no_more_coalesc;
-						p2 += _dirty_bytes_per_line;
-					} while (--h != 0);
-
-					/* Wohoo, can combine it one step to the right!
-					 * Do that, and clear the bits. */
-					right += DIRTY_BLOCK_WIDTH;
-
-					h = h2;
-					p2 = p;
-					do {
-						*p2 = 0;
-						p2 += _dirty_bytes_per_line;
-					} while (--h != 0);
+				uint last = run_last;
+				uint bottom = run_bottom;
+				if ((col_last - first) * (col_bottom - row) > (run_last - first) * (run_bottom - row)) {
+					last = col_last;
+					bottom = col_bottom;
 				}
-				no_more_coalesc:
 
-				left = x;
-				top = y;
+				for (uint r = row; r < bottom; r++) {
+					SetDirtyBlockRange(line + (r - row) * _dirty_words_per_line, first, last, false);
+				}
 
-				if (left   < _invalid_rect.left  ) left   = _invalid_rect.left;
-				if (top    < _invalid_rect.top   ) top    = _invalid_rect.top;
-				if (right  > _invalid_rect.right ) right  = _invalid_rect.right;
-				if (bottom > _invalid_rect.bottom) bottom = _invalid_rect.bottom;
+				int left   = std::max<int>(first * DIRTY_BLOCK_WIDTH, _invalid_rect.left);
+				int top    = std::max<int>(row * DIRTY_BLOCK_HEIGHT, _invalid_rect.top);
+				int right  = std::min<int>(last * DIRTY_BLOCK_WIDTH, _invalid_rect.right);
+				int bottom_px = std::min<int>(bottom * DIRTY_BLOCK_HEIGHT, _invalid_rect.bottom);
 
-				if (left < right && top < bottom) {
-					RedrawScreenRect(left, top, right, bottom);
+				if (left < right && top < bottom_px) {
+					RedrawScreenRect(left, top, right, bottom_px);
+					_dirty_redraw_stats.rects++;
+					_dirty_redraw_stats.pixels += (uint64)(right - left) * (bottom_px - top);
 				}
-
 			}
-		} while (b++, (x += DIRTY_BLOCK_WIDTH) != w);
-	} while (b += -(int)(w / DIRTY_BLOCK_WIDTH) + _dirty_bytes_per_line, (y += DIRTY_BLOCK_HEIGHT) != h);
+		}
+	}
 
 	++_dirty_block_colour;
-	_invalid_rect.left = w;
-	_invalid_rect.top = h;
+	_invalid_rect.left = _screen.width;
+	_invalid_rect.top = _screen.height;
 	_invalid_rect.right = 0;
 	_invalid_rect.bottom = 0;
 }
 
+/**
+ * Get how much of the screen was redrawn by the last #DrawDirtyBlocks.
+ * @return Number of redrawn rectangles and pixels.
+ */
+DirtyRedrawStats GetDirtyRedrawStats()
+{
+	return _dirty_redraw_stats;
+}
+
 /**
  * Extend the internal _invalid_rect rectangle to contain the rectangle
  * defined by the given parameters. Note the point (0,0) is top left.
@@ -1553,10 +1608,6 @@ void DrawDirtyBlocks()
  */
 void AddDirtyBlock(int left, int top, int right, int bottom)
 {
-	byte *b;
-	int width;
-	int height;
-
 	if (left < 0) left = 0;
 	if (top < 0) top = 0;
 	if (right > _screen.width) right = _screen.width;
@@ -1569,23 +1620,14 @@ void AddDirtyBlock(int left, int top, int right, int bottom)
 	if (right  > _invalid_rect.right ) _invalid_rect.right  = right;
 	if (bottom > _invalid_rect.bottom) _invalid_rect.bottom = bottom;
 
-	left /= DIRTY_BLOCK_WIDTH;
-	top  /= DIRTY_BLOCK_HEIGHT;
-
-	b = _dirty_blocks + top * _dirty_bytes_per_line + left;
+	uint first = left / DIRTY_BLOCK_WIDTH;
+	uint last = (right - 1) / DIRTY_BLOCK_WIDTH + 1;
 
-	width  = ((right  - 1) / DIRTY_BLOCK_WIDTH)  - left + 1;
-	height = ((bottom - 1) / DIRTY_BLOCK_HEIGHT) - top  + 1;
-
-	assert(width > 0 && height > 0);
-
-	do {
-		int i = width;
-
-		do b[--i] = 0xFF; while (i != 0);
-
-		b += _dirty_bytes_per_line;
-	} while (--height != 0);
+	uint32 *line = _dirty_blocks + (top / DIRTY_BLOCK_HEIGHT) * _dirty_words_per_line;
+	for (uint row = top / DIRTY_BLOCK_HEIGHT; row <= (uint)(bottom - 1) / DIRTY_BLOCK_HEIGHT; row++) {
+		SetDirtyBlockRange(line, first, last, true);
+		line += _dirty_words_per_line;
+	}
 }
 
 /**
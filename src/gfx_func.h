@@ -114,7 +114,14 @@ void LoadStringWidthTable(bool monospace = false);
 Point GetCharPosInString(const char *str, const char *ch, FontSize start_fontsize = FS_NORMAL);
 const char *GetCharAtPosition(const char *str, int x, FontSize start_fontsize = FS_NORMAL);
 
+/** Amount of the screen redrawn by a call to #DrawDirtyBlocks. */
+struct DirtyRedrawStats {
+	uint rects;    ///< Number of redrawn rectangles.
+	uint64 pixels; ///< Number of redrawn pixels.
+};
+
 void DrawDirtyBlocks();
+DirtyRedrawStats GetDirtyRedrawStats();
 void AddDirtyBlock(int left, int top, int right, int bottom);
 void MarkWholeScreenDirty();
 
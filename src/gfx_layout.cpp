@@ -32,6 +32,11 @@
 
 /** Cache of ParagraphLayout lines. */
 Layouter::LineCache *Layouter::linecache;
+Layouter::LineCacheLRU *Layouter::linecache_lru;
+LineCacheStats Layouter::linecache_stats;
+
+/** Number of lines kept in the line cache by #Layouter::ReduceLineCache. */
+static const size_t MAX_LINE_CACHE_SIZE = 4096;
 
 /** Cache of Font instances. */
 Layouter::FontColourMap Layouter::fonts[FS_END];
@@ -886,12 +891,31 @@ Layouter::LineCacheItem &Layouter::GetCachedParagraphLayout(const char *str, siz
 	if (linecache == nullptr) {
 		/* Create linecache on first access to avoid trouble with initialisation order of static variables. */
 		linecache = new LineCache();
+		linecache_lru = new LineCacheLRU();
 	}
 
 	LineCacheKey key;
 	key.state_before = state;
-	key.str.assign(str, len);
-	return (*linecache)[key];
+	key.str = std::string_view(str, len);
+
+	auto it = linecache->find(key);
+	if (it != linecache->end()) {
+		linecache_stats.hits++;
+		linecache_lru->splice(linecache_lru->begin(), *linecache_lru, it->second.lru_pos);
+		return it->second;
+	}
+
+	linecache_stats.misses++;
+	it = linecache->try_emplace(std::move(key)).first;
+
+	/* Let the key refer to the copy of the string owned by the cache. */
+	LineCacheItem &item = it->second;
+	item.str.assign(str, len);
+	it->first.str = item.str;
+
+	linecache_lru->push_front(&it->first);
+	item.lru_pos = linecache_lru->begin();
+	return item;
 }
 
 /**
@@ -899,16 +923,34 @@ Layouter::LineCacheItem &Layouter::GetCachedParagraphLayout(const char *str, siz
  */
 void Layouter::ResetLineCache()
 {
-	if (linecache != nullptr) linecache->clear();
+	if (linecache != nullptr) {
+		linecache->clear();
+		linecache_lru->clear();
+	}
 }
 
 /**
  * Reduce the size of linecache if necessary to prevent infinite growth.
+ * The least recently used lines are removed first.
  */
 void Layouter::ReduceLineCache()
 {
-	if (linecache != nullptr) {
-		/* TODO LRU cache would be fancy, but not exactly necessary */
-		if (linecache->size() > 4096) ResetLineCache();
+	if (linecache == nullptr) return;
+
+	while (linecache->size() > MAX_LINE_CACHE_SIZE) {
+		linecache->erase(linecache->find(*linecache_lru->back()));
+		linecache_lru->pop_back();
+		linecache_stats.evictions++;
 	}
 }
+
+/**
+ * Get the effectiveness of the line cache.
+ * @return Size and hit counts of the line cache.
+ */
+LineCacheStats Layouter::GetLineCacheStats()
+{
+	LineCacheStats stats = linecache_stats;
+	stats.size = linecache != nullptr ? linecache->size() : 0;
+	return stats;
+}
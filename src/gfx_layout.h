@@ -14,9 +14,11 @@
 #include "gfx_func.h"
 #include "core/smallmap_type.hpp"
 
-#include <map>
+#include <list>
 #include <string>
+#include <string_view>
 #include <stack>
+#include <unordered_map>
 #include <vector>
 
 #ifdef WITH_ICU_LX
@@ -143,6 +145,14 @@ public:
 	virtual std::unique_ptr<const Line> NextLine(int max_width) = 0;
 };
 
+/** Effectiveness of the cache of laid out lines of text. */
+struct LineCacheStats {
+	size_t size;      ///< Number of cached lines.
+	uint64 hits;      ///< Number of lines found in the cache.
+	uint64 misses;    ///< Number of lines that had to be laid out.
+	uint64 evictions; ///< Number of lines removed to keep the cache small.
+};
+
 /**
  * The layouter performs all the layout work.
  *
@@ -154,17 +164,34 @@ class Layouter : public std::vector<std::unique_ptr<const ParagraphLayouter::Lin
 	/** Key into the linecache */
 	struct LineCacheKey {
 		FontState state_before;  ///< Font state at the beginning of the line.
-		std::string str;         ///< Source string of the line (including colour and font size codes).
+		/**
+		 * Source string of the line (including colour and font size codes).
+		 * For lookups it refers to the string being laid out; once cached it refers to #LineCacheItem::str,
+		 * which does not change the key's hash or equality, hence it may be modified inside the cache.
+		 */
+		mutable std::string_view str;
+
+		/** Comparison operator for std::unordered_map */
+		bool operator==(const LineCacheKey &other) const
+		{
+			return this->state_before.fontsize == other.state_before.fontsize &&
+					this->state_before.cur_colour == other.state_before.cur_colour &&
+					this->state_before.colour_stack == other.state_before.colour_stack &&
+					this->str == other.str;
+		}
+	};
 
-		/** Comparison operator for std::map */
-		bool operator<(const LineCacheKey &other) const
+	/** Hash function for #LineCacheKey. */
+	struct LineCacheHash {
+		size_t operator()(const LineCacheKey &key) const
 		{
-			if (this->state_before.fontsize != other.state_before.fontsize) return this->state_before.fontsize < other.state_before.fontsize;
-			if (this->state_before.cur_colour != other.state_before.cur_colour) return this->state_before.cur_colour < other.state_before.cur_colour;
-			if (this->state_before.colour_stack != other.state_before.colour_stack) return this->state_before.colour_stack < other.state_before.colour_stack;
-			return this->str < other.str;
+			size_t h = std::hash<std::string_view>()(key.str);
+			return h ^ (key.state_before.fontsize | key.state_before.cur_colour << 8 | key.state_before.colour_stack.size() << 16);
 		}
 	};
+
+	/** List of the keys of the cached lines, from most to least recently used. */
+	typedef std::list<const LineCacheKey *> LineCacheLRU;
 public:
 	/** Item in the linecache */
 	struct LineCacheItem {
@@ -175,12 +202,17 @@ public:
 		FontState state_after;     ///< Font state after the line.
 		ParagraphLayouter *layout; ///< Layout of the line.
 
+		std::string str;           ///< Source string of the line, referred to by the key of the item.
+		LineCacheLRU::iterator lru_pos; ///< Position of the item in the least recently used list.
+
 		LineCacheItem() : buffer(nullptr), layout(nullptr) {}
 		~LineCacheItem() { delete layout; free(buffer); }
 	};
 private:
-	typedef std::map<LineCacheKey, LineCacheItem> LineCache;
+	typedef std::unordered_map<LineCacheKey, LineCacheItem, LineCacheHash> LineCache;
 	static LineCache *linecache;
+	static LineCacheLRU *linecache_lru;
+	static LineCacheStats linecache_stats;
 
 	static LineCacheItem &GetCachedParagraphLayout(const char *str, size_t len, const FontState &state);
 
@@ -197,6 +229,7 @@ public:
 	static void ResetFontCache(FontSize size);
 	static void ResetLineCache();
 	static void ReduceLineCache();
+	static LineCacheStats GetLineCacheStats();
 };
 
 #endif /* GFX_LAYOUT_H */
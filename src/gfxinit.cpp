@@ -279,6 +279,9 @@ static bool SwitchNewGRFBlitter()
 	} replacement_blitters[] = {
 		{ "8bpp-optimized",  2,  8,  8,  8,  8 },
 		{ "40bpp-anim",      2,  8, 32,  8, 32 },
+#ifdef WITH_AVX2
+		{ "32bpp-avx2",      0, 32, 32,  8, 32 },
+#endif
 #ifdef WITH_SSE
 		{ "32bpp-sse4",      0, 32, 32,  8, 32 },
 		{ "32bpp-ssse3",     0, 32, 32,  8, 32 },
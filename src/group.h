@@ -16,6 +16,7 @@
 #include "vehicle_type.h"
 #include "engine_type.h"
 #include "livery.h"
+#include "vehiclelist.h"
 #include <string>
 
 typedef Pool<Group, GroupID, 16, 64000> GroupPool;
@@ -32,6 +33,8 @@ struct GroupStatistics {
 	uint16 num_profit_vehicle;              ///< Number of vehicles considered for profit statistics;
 	Money profit_last_year;                 ///< Sum of profits for all vehicles.
 
+	VehicleList vehicles;                   ///< The primary vehicles in the group, in no particular order.
+
 	GroupStatistics();
 	~GroupStatistics();
 
@@ -47,6 +47,7 @@ void GroupStatistics::Clear()
 	this->num_vehicle = 0;
 	this->num_profit_vehicle = 0;
 	this->profit_last_year = 0;
+	this->vehicles.clear();
 
 	/* This is also called when NewGRF change. So the number of engines might have changed. Reallocate. */
 	free(this->num_engines);
@@ -126,7 +127,29 @@ void GroupStatistics::Clear()
 }
 
 /**
- * Update num_vehicle when adding or removing a vehicle.
+ * Add a vehicle to or remove a vehicle from a list of primary vehicles.
+ * @param vehicles The list to update.
+ * @param v Vehicle to add or remove.
+ * @param delta +1 to add, -1 to remove.
+ */
+static void UpdateGroupVehicleList(VehicleList &vehicles, const Vehicle *v, int delta)
+{
+	if (delta > 0) {
+		vehicles.push_back(v);
+		return;
+	}
+
+	/* Vehicles deleted while loading a savegame were never counted. */
+	auto it = std::find(vehicles.begin(), vehicles.end(), v);
+	if (it == vehicles.end()) return;
+
+	/* The order of the list does not matter, so fill the hole with the last vehicle. */
+	*it = vehicles.back();
+	vehicles.pop_back();
+}
+
+/**
+ * Update num_vehicle and the vehicle lists when adding or removing a vehicle.
  * @param v Vehicle to count.
  * @param delta +1 to add, -1 to remove.
  */
@@ -139,6 +162,8 @@ void GroupStatistics::Clear()
 
 	stats_all.num_vehicle += delta;
 	stats.num_vehicle += delta;
+	UpdateGroupVehicleList(stats_all.vehicles, v, delta);
+	UpdateGroupVehicleList(stats.vehicles, v, delta);
 
 	if (v->age > VEHICLE_PROFIT_MIN_AGE) {
 		stats_all.num_profit_vehicle += delta;
@@ -51,6 +51,8 @@ void LinkGraphOverlay::RebuildCache()
 {
 	this->cached_links.clear();
 	this->cached_stations.clear();
+	this->cached_segments.clear();
+	this->segment_grid.clear();
 	if (this->company_mask == 0) return;
 
 	DrawPixelInfo dpi;
@@ -96,6 +98,81 @@ void LinkGraphOverlay::RebuildCache()
 			this->cached_stations.push_back(std::make_pair(from, supply));
 		}
 	}
+
+	this->RebuildSegments();
+}
+
+/**
+ * Get the parts of the view of the window that determine where stations are drawn.
+ * The smallmap rebuilds the cache whenever it scrolls or zooms, so apart from the size only a viewport can change its view between rebuilds.
+ * @return The current view state.
+ */
+LinkGraphOverlay::ViewState LinkGraphOverlay::GetViewState() const
+{
+	ViewState view = {};
+	const Viewport *vp = this->window->viewport;
+	if (vp != nullptr) {
+		view.left = vp->left;
+		view.top = vp->top;
+		view.virtual_left = vp->virtual_left;
+		view.virtual_top = vp->virtual_top;
+		view.zoom = vp->zoom;
+	}
+	const NWidgetBase *wi = this->window->GetWidget<NWidgetBase>(this->widget_id);
+	view.width = wi->current_x;
+	view.height = wi->current_y;
+	return view;
+}
+
+/**
+ * Make the list of link segments to draw from the cached links.
+ */
+void LinkGraphOverlay::RebuildSegments()
+{
+	for (const auto &from : this->cached_links) {
+		for (const auto &to : from.second) {
+			this->cached_segments.push_back({from.first, to.first, &to.second, {0, 0}, {0, 0}});
+		}
+	}
+
+	this->segment_view = this->GetViewState();
+	this->segment_grid.clear();
+	this->UpdateSegmentPositions();
+}
+
+/**
+ * Compute the positions of the cached link segments for the current view
+ * and sort them into a grid over the window, so drawing a part of the window
+ * only needs to look at the links that can be inside that part.
+ */
+void LinkGraphOverlay::UpdateSegmentPositions()
+{
+	ViewState view = this->GetViewState();
+	if (view == this->segment_view && !this->segment_grid.empty()) return;
+	this->segment_view = view;
+
+	this->segment_grid_columns = std::max<int>(1, CeilDiv(view.width, SEGMENT_GRID_CELL_SIZE));
+	this->segment_grid_rows = std::max<int>(1, CeilDiv(view.height, SEGMENT_GRID_CELL_SIZE));
+	this->segment_grid.assign(this->segment_grid_columns * this->segment_grid_rows, std::vector<uint>());
+
+	for (uint i = 0; i < this->cached_segments.size(); i++) {
+		LinkSegment &segment = this->cached_segments[i];
+		if (!Station::IsValidID(segment.from) || !Station::IsValidID(segment.to)) continue;
+		segment.pta = this->GetStationMiddle(Station::Get(segment.from));
+		segment.ptb = this->GetStationMiddle(Station::Get(segment.to));
+
+		/* The grid starts at the top left of the viewport, which is not at the origin of the screen
+		 * coordinates of the stations. Links outside of the window are kept in the cells at its edges. */
+		int left = Clamp((std::min(segment.pta.x, segment.ptb.x) - view.left) / SEGMENT_GRID_CELL_SIZE, 0, this->segment_grid_columns - 1);
+		int right = Clamp((std::max(segment.pta.x, segment.ptb.x) - view.left) / SEGMENT_GRID_CELL_SIZE, 0, this->segment_grid_columns - 1);
+		int top = Clamp((std::min(segment.pta.y, segment.ptb.y) - view.top) / SEGMENT_GRID_CELL_SIZE, 0, this->segment_grid_rows - 1);
+		int bottom = Clamp((std::max(segment.pta.y, segment.ptb.y) - view.top) / SEGMENT_GRID_CELL_SIZE, 0, this->segment_grid_rows - 1);
+		for (int y = top; y <= bottom; y++) {
+			for (int x = left; x <= right; x++) {
+				this->segment_grid[y * this->segment_grid_columns + x].push_back(i);
+			}
+		}
+	}
 }
 
 /**
@@ -242,6 +319,7 @@ void LinkGraphOverlay::Draw(const DrawPixelInfo *dpi)
 		this->RebuildCache();
 		this->dirty = false;
 	}
+	this->UpdateSegmentPositions();
 	this->DrawLinks(dpi);
 	this->DrawStationDots(dpi);
 }
@@ -252,16 +330,32 @@ void LinkGraphOverlay::Draw(const DrawPixelInfo *dpi)
  */
 void LinkGraphOverlay::DrawLinks(const DrawPixelInfo *dpi) const
 {
-	for (LinkMap::const_iterator i(this->cached_links.begin()); i != this->cached_links.end(); ++i) {
-		if (!Station::IsValidID(i->first)) continue;
-		Point pta = this->GetStationMiddle(Station::Get(i->first));
-		for (StationLinkMap::const_iterator j(i->second.begin()); j != i->second.end(); ++j) {
-			if (!Station::IsValidID(j->first)) continue;
-			Point ptb = this->GetStationMiddle(Station::Get(j->first));
-			if (!this->IsLinkVisible(pta, ptb, dpi, this->scale + 2)) continue;
-			this->DrawContent(pta, ptb, j->second);
+	if (this->segment_grid.empty()) return;
+
+	const int padding = this->scale + 2;
+	const ViewState &view = this->segment_view;
+	int left = Clamp((dpi->left - padding - view.left) / SEGMENT_GRID_CELL_SIZE, 0, this->segment_grid_columns - 1);
+	int right = Clamp((dpi->left + dpi->width + padding - view.left) / SEGMENT_GRID_CELL_SIZE, 0, this->segment_grid_columns - 1);
+	int top = Clamp((dpi->top - padding - view.top) / SEGMENT_GRID_CELL_SIZE, 0, this->segment_grid_rows - 1);
+	int bottom = Clamp((dpi->top + dpi->height + padding - view.top) / SEGMENT_GRID_CELL_SIZE, 0, this->segment_grid_rows - 1);
+
+	/* Collect the links near the area; they are drawn in the order of the cache, once each. */
+	std::vector<uint> segments;
+	for (int y = top; y <= bottom; y++) {
+		for (int x = left; x <= right; x++) {
+			const std::vector<uint> &cell = this->segment_grid[y * this->segment_grid_columns + x];
+			segments.insert(segments.end(), cell.begin(), cell.end());
 		}
 	}
+	std::sort(segments.begin(), segments.end());
+	segments.erase(std::unique(segments.begin(), segments.end()), segments.end());
+
+	for (uint i : segments) {
+		const LinkSegment &segment = this->cached_segments[i];
+		if (!Station::IsValidID(segment.from) || !Station::IsValidID(segment.to)) continue;
+		if (!this->IsLinkVisible(segment.pta, segment.ptb, dpi, padding)) continue;
+		this->DrawContent(segment.pta, segment.ptb, *segment.cargo);
+	}
 }
 
 /**
@@ -40,7 +40,35 @@ public:
 	typedef std::map<StationID, StationLinkMap> LinkMap;
 	typedef std::vector<std::pair<StationID, uint> > StationSupplyList;
 
+	/** A cached link together with the position of its ends in the window. */
+	struct LinkSegment {
+		StationID from;              ///< Station at the start of the link.
+		StationID to;                ///< Station at the end of the link.
+		const LinkProperties *cargo; ///< Properties of the link, stored in #cached_links.
+		Point pta;                   ///< Middle of the station at the start of the link.
+		Point ptb;                   ///< Middle of the station at the end of the link.
+	};
+
+	/** The parts of the view of the window that determine where stations are drawn. */
+	struct ViewState {
+		int left;         ///< Left edge of the viewport.
+		int top;          ///< Top edge of the viewport.
+		int virtual_left; ///< Virtual left coordinate of the viewport.
+		int virtual_top;  ///< Virtual top coordinate of the viewport.
+		ZoomLevel zoom;   ///< Zoom level of the viewport.
+		int width;        ///< Width of the widget the overlay is drawn on.
+		int height;       ///< Height of the widget the overlay is drawn on.
+
+		bool operator==(const ViewState &other) const
+		{
+			return this->left == other.left && this->top == other.top && this->virtual_left == other.virtual_left &&
+					this->virtual_top == other.virtual_top && this->zoom == other.zoom &&
+					this->width == other.width && this->height == other.height;
+		}
+	};
+
 	static const uint8 LINK_COLOURS[];
+	static const int SEGMENT_GRID_CELL_SIZE = 64; ///< Width and height in pixels of a cell of the link segment index.
 
 	/**
 	 * Create a link graph overlay for the specified window.
@@ -51,7 +79,8 @@ public:
 	 * @param scale Desired thickness of lines and size of station dots.
 	 */
 	LinkGraphOverlay(const Window *w, uint wid, CargoTypes cargo_mask, uint32 company_mask, uint scale) :
-			window(w), widget_id(wid), cargo_mask(cargo_mask), company_mask(company_mask), scale(scale)
+			window(w), widget_id(wid), cargo_mask(cargo_mask), company_mask(company_mask), scale(scale),
+			segment_grid_columns(0), segment_grid_rows(0), segment_view()
 	{}
 
 	void Draw(const DrawPixelInfo *dpi);
@@ -77,7 +106,16 @@ protected:
 	uint scale;                        ///< Width of link lines.
 	bool dirty;                        ///< Set if overlay should be rebuilt.
 
+	std::vector<LinkSegment> cached_segments;   ///< All cached links, in drawing order, with their positions.
+	std::vector<std::vector<uint>> segment_grid; ///< Indices into #cached_segments of the links whose bounding box touches each cell of the window.
+	int segment_grid_columns;                   ///< Number of columns of #segment_grid.
+	int segment_grid_rows;                      ///< Number of rows of #segment_grid.
+	ViewState segment_view;                     ///< View the positions in #cached_segments were computed for.
+
 	Point GetStationMiddle(const Station *st) const;
+	ViewState GetViewState() const;
+	void RebuildSegments();
+	void UpdateSegmentPositions();
 
 	void AddLinks(const Station *sta, const Station *stb);
 	void DrawLinks(const DrawPixelInfo *dpi) const;
@@ -30,6 +30,7 @@
 #include "town_kdtree.h"
 #include "viewport_kdtree.h"
 #include "newgrf_profiling.h"
+#include "pbs_cache.h"
 
 #include "safeguards.h"
 
@@ -79,6 +80,7 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 
 	LinkGraphSchedule::Clear();
 	PoolBase::Clean(PT_NORMAL);
+	InvalidateReservationCache();
 
 	RebuildStationKdtree();
 	RebuildTownKdtree();
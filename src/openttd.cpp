@@ -376,6 +376,7 @@ void MakeNewgameSettingsLive()
 	 * Also initialise old settings needed for savegame conversion. */
 	_settings_game = _settings_newgame;
 	_old_vds = _settings_client.company.vehicle;
+	InvalidateStringCache();
 
 	for (CompanyID c = COMPANY_FIRST; c < MAX_COMPANIES; c++) {
 		_settings_game.ai_config[c] = nullptr;
@@ -1479,8 +1480,6 @@ void GameLoop()
 		_switch_mode = SM_NONE;
 	}
 
-	IncreaseSpriteLRU();
-
 	/* Check for UDP stuff */
 	if (_network_available) NetworkBackgroundLoop();
 
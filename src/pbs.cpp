@@ -15,6 +15,21 @@
 
 #include "safeguards.h"
 
+uint32 _reservation_version; ///< Increased whenever reserved paths might have changed.
+
+/** The end of the last followed train reservation, see #GetTrainReservationEnd. */
+struct ReservationEndCache {
+	const Train *v;     ///< The train the reservation was followed for.
+	TileIndex tile;     ///< The tile the train was on.
+	Trackdir trackdir;  ///< The trackdir of the train.
+	RailType railtype;  ///< The rail type of the train.
+	Owner owner;        ///< The owner of the train.
+	uint32 version;     ///< The #_reservation_version at the time it was followed.
+	PBSTileInfo res;    ///< The end of the reservation.
+};
+
+static ReservationEndCache _reservation_end_cache;
+
 /**
  * Get the reserved trackbits for any tile, regardless of type.
  * @param t the tile
@@ -279,6 +294,44 @@ static Vehicle *FindTrainOnTrackEnum(Vehicle *v, void *data)
 	return nullptr;
 }
 
+/**
+ * Follow the reservation of a train to its end and check whether that is a safe waiting position.
+ * The train controller and the pathfinders ask this several times per train and tick, so the
+ * last result is kept until the reserved paths might have changed.
+ * @param v the train
+ * @param tile the tile the train is on
+ * @param trackdir the trackdir of the train
+ * @return The end of the reservation.
+ */
+static PBSTileInfo GetTrainReservationEnd(const Train *v, TileIndex tile, Trackdir trackdir)
+{
+	ReservationEndCache &cache = _reservation_end_cache;
+
+	if (cache.version == _reservation_version && cache.v == v && cache.tile == tile && cache.trackdir == trackdir &&
+			cache.railtype == v->railtype && cache.owner == v->owner) {
+#ifdef _DEBUG
+		/* Make sure nothing changed the reservation without invalidating the cache. */
+		PBSTileInfo check = FollowReservation(v->owner, GetRailTypeInfo(v->railtype)->compatible_railtypes, tile, trackdir);
+		check.okay = IsSafeWaitingPosition(v, check.tile, check.trackdir, true, _settings_game.pf.forbid_90_deg);
+		assert(check.tile == cache.res.tile && check.trackdir == cache.res.trackdir && check.okay == cache.res.okay);
+#endif
+		return cache.res;
+	}
+
+	PBSTileInfo res = FollowReservation(v->owner, GetRailTypeInfo(v->railtype)->compatible_railtypes, tile, trackdir);
+	res.okay = IsSafeWaitingPosition(v, res.tile, res.trackdir, true, _settings_game.pf.forbid_90_deg);
+
+	cache.v = v;
+	cache.tile = tile;
+	cache.trackdir = trackdir;
+	cache.railtype = v->railtype;
+	cache.owner = v->owner;
+	cache.version = _reservation_version;
+	cache.res = res;
+
+	return res;
+}
+
 /**
  * Follow a train reservation to the last tile.
  *
@@ -296,8 +349,7 @@ PBSTileInfo FollowTrainReservation(const Train *v, Vehicle **train_on_res)
 	if (IsRailDepotTile(tile) && !GetDepotReservationTrackBits(tile)) return PBSTileInfo(tile, trackdir, false);
 
 	FindTrainOnTrackInfo ftoti;
-	ftoti.res = FollowReservation(v->owner, GetRailTypeInfo(v->railtype)->compatible_railtypes, tile, trackdir);
-	ftoti.res.okay = IsSafeWaitingPosition(v, ftoti.res.tile, ftoti.res.trackdir, true, _settings_game.pf.forbid_90_deg);
+	ftoti.res = GetTrainReservationEnd(v, tile, trackdir);
 	if (train_on_res != nullptr) {
 		FindVehicleOnPos(ftoti.res.tile, &ftoti, FindTrainOnTrackEnum);
 		if (ftoti.best != nullptr) *train_on_res = ftoti.best->First();
@@ -14,6 +14,7 @@
 #include "direction_type.h"
 #include "track_type.h"
 #include "vehicle_type.h"
+#include "pbs_cache.h"
 
 TrackBits GetReservedTrackbits(TileIndex t);
 
@@ -0,0 +1,24 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file pbs_cache.h Invalidation of the cached ends of train reservations. */
+
+#ifndef PBS_CACHE_H
+#define PBS_CACHE_H
+
+extern uint32 _reservation_version;
+
+/**
+ * Note that reserved paths might have changed, so the cached end
+ * of a train's reservation may no longer be used.
+ */
+static inline void InvalidateReservationCache()
+{
+	_reservation_version++;
+}
+
+#endif /* PBS_CACHE_H */
@@ -657,7 +657,8 @@ static RoadVehicle *RoadVehFindCloseTo(RoadVehicle *v, int x, int y, Direction d
 	if (front->state == RVSB_WORMHOLE) {
 		FindVehicleOnPos(v->tile, &rvf, EnumCheckRoadVehClose);
 		FindVehicleOnPos(GetOtherTunnelBridgeEnd(v->tile), &rvf, EnumCheckRoadVehClose);
-	} else {
+	} else if (front->HasArticulatedPart() || CountVehiclesOnPosXY(x, y, VEH_ROAD, v) != 0) {
+		/* A single part vehicle does not need to search when it is the only road vehicle around. */
 		FindVehicleOnPosXY(x, y, &rvf, EnumCheckRoadVehClose);
 	}
 
@@ -790,6 +791,7 @@ static bool CheckRoadBlockedForOvertaking(OvertakeData *od)
 	if (!HasBit(trackdirbits, od->trackdir) || (trackbits & ~TRACK_BIT_CROSS) || (red_signals != TRACKDIR_BIT_NONE)) return true;
 
 	/* Are there more vehicles on the tile except the two vehicles involved in overtaking */
+	if (CountVehiclesOnPos(od->tile, VEH_ROAD) <= (uint)(od->u->tile == od->tile) + (uint)(od->v->tile == od->tile)) return false;
 	return HasVehicleOnPos(od->tile, od, EnumFindVehBlockingOvertake);
 }
 
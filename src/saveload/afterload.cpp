@@ -22,6 +22,7 @@
 #include "../clear_map.h"
 #include "../vehicle_func.h"
 #include "../string_func.h"
+#include "../strings_func.h"
 #include "../date_func.h"
 #include "../roadveh.h"
 #include "../train.h"
@@ -560,6 +561,11 @@ bool AfterLoadGame()
 	 * that otherwise won't exist in the tree. */
 	RebuildViewportKdtree();
 
+	/* Trains of the previous game may have lived at the same addresses. */
+	InvalidateReservationCache();
+	/* The loaded locale settings may format strings differently. */
+	InvalidateStringCache();
+
 	if (IsSavegameVersionBefore(SLV_98)) GamelogGRFAddList(_grfconfig);
 
 	if (IsSavegameVersionBefore(SLV_119)) {
@@ -792,6 +798,9 @@ bool AfterLoadGame()
 		}
 	}
 
+	/* The loaded map may differ in size from the one the vehicle hash was made for. */
+	ResetVehicleHash();
+
 	/* Update all vehicles */
 	AfterLoadVehicles(true);
 
@@ -3199,6 +3208,8 @@ void ReloadNewGRFData()
 	for (CompanyID i = COMPANY_FIRST; i < MAX_COMPANIES; i++) InvalidateWindowData(WC_COMPANY_COLOUR, i);
 	/* Update company infrastructure counts. */
 	InvalidateWindowClassesData(WC_COMPANY_INFRASTRUCTURE);
+	/* The map colours of rail types, road types and industries may have changed. */
+	ResetViewportLodColours();
 	/* redraw the whole screen */
 	MarkWholeScreenDirty();
 	CheckTrainsLengths();
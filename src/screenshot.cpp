@@ -26,6 +26,8 @@
 #include "tile_map.h"
 #include "landscape.h"
 #include "video/video_driver.hpp"
+#include "thread.h"
+#include "console_func.h"
 
 #include "table/strings.h"
 
@@ -60,9 +62,10 @@ typedef void ScreenshotCallback(void *userdata, void *buf, uint y, uint pitch, u
  * @param h           Height of the image in pixels.
  * @param pixelformat Bits per pixel (bpp), either 8 or 32.
  * @param palette     %Colour palette (for 8bpp images).
+ * @param large       Whether the image is a large screenshot of the world, which may use more memory and a thread for writing.
  * @return File was written successfully.
  */
-typedef bool ScreenshotHandlerProc(const char *name, ScreenshotCallback *callb, void *userdata, uint w, uint h, int pixelformat, const Colour *palette);
+typedef bool ScreenshotHandlerProc(const char *name, ScreenshotCallback *callb, void *userdata, uint w, uint h, int pixelformat, const Colour *palette, bool large);
 
 /** Screenshot format information. */
 struct ScreenshotFormat {
@@ -109,10 +112,11 @@ static_assert(sizeof(RgbQuad) == 4);
  * @param h height in pixels
  * @param pixelformat bits per pixel
  * @param palette colour palette (for 8bpp mode)
+ * @param large whether the image is a large screenshot of the world
  * @return was everything ok?
  * @see ScreenshotHandlerProc
  */
-static bool MakeBMPImage(const char *name, ScreenshotCallback *callb, void *userdata, uint w, uint h, int pixelformat, const Colour *palette)
+static bool MakeBMPImage(const char *name, ScreenshotCallback *callb, void *userdata, uint w, uint h, int pixelformat, const Colour *palette, bool large)
 {
 	uint bpp; // bytes per pixel
 	switch (pixelformat) {
@@ -226,6 +230,8 @@ static bool MakeBMPImage(const char *name, ScreenshotCallback *callb, void *user
  *********************************************************/
 #if defined(WITH_PNG)
 #include <png.h>
+#include <mutex>
+#include <condition_variable>
 
 #ifdef PNG_TEXT_SUPPORTED
 #include "rev.h"
@@ -246,6 +252,66 @@ static void PNGAPI png_my_warning(png_structp png_ptr, png_const_charp message)
 	DEBUG(misc, 1, "[libpng] warning: %s - %s", message, (const char *)png_get_error_ptr(png_ptr));
 }
 
+/**
+ * Double buffer of rendered lines that is passed between the thread rendering
+ * the screenshot and the thread compressing those lines into the .PNG file.
+ */
+struct PNGLineQueue {
+	png_structp png_ptr;         ///< PNG file the lines are written to.
+	uint line_size;              ///< Size of a single line in bytes.
+	uint8 *buffers[2];           ///< Buffers; while one is compressed the other one is being rendered.
+	uint lines[2] = { 0, 0 };    ///< Number of rendered lines in each buffer, 0 when the buffer is free.
+	bool finished = false;       ///< No more lines will be rendered.
+	bool failed = false;         ///< Writing the file failed; rendering can stop.
+	std::mutex lock;             ///< Lock for all of the above.
+	std::condition_variable cv;  ///< Signalled whenever a buffer changes hands.
+};
+
+/**
+ * Write some lines of a buffer to the .PNG file.
+ * @param png_ptr   PNG file to write to.
+ * @param buf       Buffer with the lines.
+ * @param line_size Size of a single line in bytes.
+ * @param n         Number of lines to write.
+ */
+static void WritePNGLines(png_structp png_ptr, uint8 *buf, uint line_size, uint n)
+{
+	for (uint i = 0; i != n; i++) {
+		png_write_row(png_ptr, (png_bytep)buf + i * line_size);
+	}
+}
+
+/**
+ * Thread compressing the rendered lines into the .PNG file, in the order the buffers were filled.
+ * @param q Queue to take the lines from.
+ */
+static void PNGWriterThread(PNGLineQueue *q)
+{
+	/* libpng errors jump back to the thread that set up the jump buffer, so this thread needs its own. */
+	if (setjmp(png_jmpbuf(q->png_ptr))) {
+		std::lock_guard<std::mutex> lock(q->lock);
+		q->failed = true;
+		q->cv.notify_all();
+		return;
+	}
+
+	for (uint b = 0;; b ^= 1) {
+		uint n;
+		{
+			std::unique_lock<std::mutex> lock(q->lock);
+			q->cv.wait(lock, [&]() { return q->lines[b] != 0 || q->finished; });
+			n = q->lines[b];
+		}
+		if (n == 0) return;
+
+		WritePNGLines(q->png_ptr, q->buffers[b], q->line_size, n);
+
+		std::lock_guard<std::mutex> lock(q->lock);
+		q->lines[b] = 0;
+		q->cv.notify_all();
+	}
+}
+
 /**
  * Generic .PNG file image writer.
  * @param name        Filename, including extension.
@@ -255,10 +321,11 @@ static void PNGAPI png_my_warning(png_structp png_ptr, png_const_charp message)
  * @param h           Height of the image in pixels.
  * @param pixelformat Bits per pixel (bpp), either 8 or 32.
  * @param palette     %Colour palette (for 8bpp images).
+ * @param large       Whether the image is a large screenshot of the world.
  * @return File was written successfully.
  * @see ScreenshotHandlerProc
  */
-static bool MakePNGImage(const char *name, ScreenshotCallback *callb, void *userdata, uint w, uint h, int pixelformat, const Colour *palette)
+static bool MakePNGImage(const char *name, ScreenshotCallback *callb, void *userdata, uint w, uint h, int pixelformat, const Colour *palette, bool large)
 {
 	png_color rq[256];
 	FILE *f;
@@ -368,31 +435,87 @@ static bool MakePNGImage(const char *name, ScreenshotCallback *callb, void *user
 #endif /* TTD_ENDIAN == TTD_LITTLE_ENDIAN */
 	}
 
-	/* use by default 64k temp memory */
-	maxlines = Clamp(65536 / w, 16, 128);
+	if (large) {
+		/* Use up to 16 MiB of temp memory per buffer. Every strip has to collect the
+		 * sprites of all tiles overlapping it, so taller strips mean less duplicate work. */
+		maxlines = Clamp(16 * 1024 * 1024 / (w * bpp), 16, 128);
+	} else {
+		/* use by default 64k temp memory */
+		maxlines = Clamp(65536 / w, 16, 128);
+	}
+
+	/* Rendering has to stay on this thread, but for large screenshots compressing the lines
+	 * can be done on another one meanwhile. Other screenshots, especially the one made
+	 * while crashing, are not worth starting a thread for. */
+	bool threaded = large && h > 2 * maxlines;
 
 	/* now generate the bitmap bits */
-	void *buff = CallocT<uint8>(w * maxlines * bpp); // by default generate 128 lines at a time.
+	PNGLineQueue q;
+	q.png_ptr = png_ptr;
+	q.line_size = w * bpp;
+	q.buffers[0] = CallocT<uint8>(w * maxlines * bpp);
+	q.buffers[1] = threaded ? CallocT<uint8>(w * maxlines * bpp) : nullptr;
+
+	std::thread writer;
+	if (threaded) threaded = StartNewThread(&writer, "ottd:screenshot", &PNGWriterThread, &q);
 
+	uint b = 0;
 	y = 0;
 	do {
 		/* determine # lines to write */
 		n = std::min(h - y, maxlines);
 
+		if (threaded) {
+			/* wait for the writer to be done with this buffer */
+			std::unique_lock<std::mutex> lock(q.lock);
+			q.cv.wait(lock, [&]() { return q.lines[b] == 0 || q.failed; });
+			if (q.failed) break;
+		}
+
 		/* render the pixels into the buffer */
-		callb(userdata, buff, y, w, n);
+		callb(userdata, q.buffers[b], y, w, n);
 		y += n;
 
-		/* write them to png */
-		for (i = 0; i != n; i++) {
-			png_write_row(png_ptr, (png_bytep)buff + i * w * bpp);
+		if (threaded) {
+			/* hand the lines over to the writer and continue in the other buffer */
+			std::lock_guard<std::mutex> lock(q.lock);
+			q.lines[b] = n;
+			q.cv.notify_all();
+			b ^= 1;
+		} else {
+			/* write them to png */
+			WritePNGLines(png_ptr, q.buffers[b], q.line_size, n);
 		}
 	} while (y != h);
 
+	if (threaded) {
+		{
+			std::lock_guard<std::mutex> lock(q.lock);
+			q.finished = true;
+			q.cv.notify_all();
+		}
+		writer.join();
+	}
+
+	free(q.buffers[0]);
+	free(q.buffers[1]);
+
+	if (q.failed) {
+		png_destroy_write_struct(&png_ptr, &info_ptr);
+		fclose(f);
+		return false;
+	}
+
+	/* The writer thread replaced the jump buffer; errors from here on should return here again. */
+	if (setjmp(png_jmpbuf(png_ptr))) {
+		png_destroy_write_struct(&png_ptr, &info_ptr);
+		fclose(f);
+		return false;
+	}
+
 	png_write_end(png_ptr, info_ptr);
 	png_destroy_write_struct(&png_ptr, &info_ptr);
 
-	free(buff);
 	fclose(f);
 	return true;
 }
@@ -432,10 +555,11 @@ static_assert(sizeof(PcxHeader) == 128);
  * @param h           Height of the image in pixels.
  * @param pixelformat Bits per pixel (bpp), either 8 or 32.
  * @param palette     %Colour palette (for 8bpp images).
+ * @param large       Whether the image is a large screenshot of the world.
  * @return File was written successfully.
  * @see ScreenshotHandlerProc
  */
-static bool MakePCXImage(const char *name, ScreenshotCallback *callb, void *userdata, uint w, uint h, int pixelformat, const Colour *palette)
+static bool MakePCXImage(const char *name, ScreenshotCallback *callb, void *userdata, uint w, uint h, int pixelformat, const Colour *palette, bool large)
 {
 	FILE *f;
 	uint maxlines;
@@ -604,9 +728,15 @@ static void CurrentScreenCallback(void *userdata, void *buf, uint y, uint pitch,
 	blitter->CopyImageToBuffer(src, buf, _screen.width, n, pitch);
 }
 
+/** Data for #LargeWorldCallback. */
+struct LargeWorldScreenshot {
+	ScreenshotType type; ///< Type of the screenshot.
+	Viewport vp;         ///< Viewport area to draw.
+};
+
 /**
  * generate a large piece of the world
- * @param userdata Viewport area to draw
+ * @param userdata #LargeWorldScreenshot with the viewport area to draw
  * @param buf Videobuffer with same bitdepth as current blitter
  * @param y First line to render
  * @param pitch Pitch of the videobuffer
@@ -614,7 +744,8 @@ static void CurrentScreenCallback(void *userdata, void *buf, uint y, uint pitch,
  */
 static void LargeWorldCallback(void *userdata, void *buf, uint y, uint pitch, uint n)
 {
-	Viewport *vp = (Viewport *)userdata;
+	const LargeWorldScreenshot *ls = (const LargeWorldScreenshot *)userdata;
+	const Viewport *vp = &ls->vp;
 	DrawPixelInfo dpi, *old_dpi;
 	int wx, left;
 
@@ -658,6 +789,12 @@ static void LargeWorldCallback(void *userdata, void *buf, uint y, uint pitch, ui
 	/* Switch back to rendering to the screen */
 	_screen = old_screen;
 	_screen_disable_anim = old_disable_anim;
+
+	/* World screenshots can take quite a while, so tell how far we are. */
+	if (ls->type == SC_WORLD) {
+		uint progress = (y + n) * 10 / (uint)vp->height;
+		if (progress != y * 10 / (uint)vp->height) IConsolePrintF(CC_DEFAULT, "Rendering world screenshot: %u%% done", progress * 10);
+	}
 }
 
 /**
@@ -705,7 +842,7 @@ static bool MakeSmallScreenshot(bool crashlog)
 {
 	const ScreenshotFormat *sf = _screenshot_formats + _cur_screenshot_format;
 	return sf->proc(MakeScreenshotName(SCREENSHOT_NAME, sf->extension, crashlog), CurrentScreenCallback, nullptr, _screen.width, _screen.height,
-			BlitterFactory::GetCurrentBlitter()->GetScreenDepth(), _cur_palette.palette);
+			BlitterFactory::GetCurrentBlitter()->GetScreenDepth(), _cur_palette.palette, false);
 }
 
 /**
@@ -798,12 +935,13 @@ void SetupScreenshotViewport(ScreenshotType t, Viewport *vp, uint32 width, uint3
  */
 static bool MakeLargeWorldScreenshot(ScreenshotType t, uint32 width = 0, uint32 height = 0)
 {
-	Viewport vp;
-	SetupScreenshotViewport(t, &vp, width, height);
+	LargeWorldScreenshot ls;
+	ls.type = t;
+	SetupScreenshotViewport(t, &ls.vp, width, height);
 
 	const ScreenshotFormat *sf = _screenshot_formats + _cur_screenshot_format;
-	return sf->proc(MakeScreenshotName(SCREENSHOT_NAME, sf->extension), LargeWorldCallback, &vp, vp.width, vp.height,
-			BlitterFactory::GetCurrentBlitter()->GetScreenDepth(), _cur_palette.palette);
+	return sf->proc(MakeScreenshotName(SCREENSHOT_NAME, sf->extension), LargeWorldCallback, &ls, ls.vp.width, ls.vp.height,
+			BlitterFactory::GetCurrentBlitter()->GetScreenDepth(), _cur_palette.palette, true);
 }
 
 /**
@@ -852,7 +990,7 @@ bool MakeHeightmapScreenshot(const char *filename)
 	}
 
 	const ScreenshotFormat *sf = _screenshot_formats + _cur_screenshot_format;
-	return sf->proc(filename, HeightmapCallback, nullptr, MapSizeX(), MapSizeY(), 8, palette);
+	return sf->proc(filename, HeightmapCallback, nullptr, MapSizeX(), MapSizeY(), 8, palette, false);
 }
 
 static ScreenshotType _confirmed_screenshot_type; ///< Screenshot type the current query is about to confirm.
@@ -1038,5 +1176,5 @@ static void MinimapScreenCallback(void *userdata, void *buf, uint y, uint pitch,
 bool MakeMinimapWorldScreenshot()
 {
 	const ScreenshotFormat *sf = _screenshot_formats + _cur_screenshot_format;
-	return sf->proc(MakeScreenshotName(SCREENSHOT_NAME, sf->extension), MinimapScreenCallback, nullptr, MapSizeX(), MapSizeY(), 32, _cur_palette.palette);
+	return sf->proc(MakeScreenshotName(SCREENSHOT_NAME, sf->extension), MinimapScreenCallback, nullptr, MapSizeX(), MapSizeY(), 32, _cur_palette.palette, false);
 }
@@ -873,6 +873,19 @@ static bool RedrawScreen(int32 p1)
 	return true;
 }
 
+/**
+ * Redraw the whole screen after a change of the locale settings,
+ * as all strings with e.g. numbers or money have to be formatted again.
+ * @param p1 unused.
+ * @return Always true.
+ */
+static bool RedrawLocale(int32 p1)
+{
+	InvalidateStringCache();
+	MarkWholeScreenDirty();
+	return true;
+}
+
 /**
  * Redraw the smallmap after a colour scheme change.
  * @param p1 Callback parameter.
@@ -530,6 +530,7 @@ struct GameOptionsWindow : Window {
 			case WID_GO_CURRENCY_DROPDOWN: // Currency
 				if (index == CURRENCY_CUSTOM) ShowCustCurrency();
 				this->opt->locale.currency = index;
+				InvalidateStringCache();
 				ReInitAllWindows();
 				break;
 
@@ -1591,6 +1592,7 @@ static SettingsContainer &GetSettingsTree()
 			graphics->Add(new SettingEntry("gui.zoom_min"));
 			graphics->Add(new SettingEntry("gui.zoom_max"));
 			graphics->Add(new SettingEntry("gui.sprite_zoom_min"));
+			graphics->Add(new SettingEntry("gui.viewport_lod_zoom"));
 			graphics->Add(new SettingEntry("gui.smallmap_land_colour"));
 			graphics->Add(new SettingEntry("gui.graph_line_thickness"));
 		}
@@ -2722,6 +2724,7 @@ struct CustomCurrencyWindow : Window {
 			ShowQueryString(str, STR_CURRENCY_CHANGE_PARAMETER, len + 1, this, afilter, QSF_NONE);
 		}
 
+		InvalidateStringCache();
 		this->SetTimeout();
 		this->SetDirty();
 	}
@@ -2754,6 +2757,7 @@ struct CustomCurrencyWindow : Window {
 				break;
 			}
 		}
+		InvalidateStringCache();
 		MarkWholeScreenDirty();
 		SetButtonState();
 	}
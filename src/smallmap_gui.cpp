@@ -162,6 +162,25 @@ static bool _smallmap_industry_highlight_state;
 /** For connecting company ID to position in owner list (small map legend) */
 static uint _company_to_list_pos[MAX_COMPANIES];
 
+/**
+ * Colours of the groups of tiles shown as one pixel pair by the smallmap.
+ * A colour is computed when its group is first drawn, and only recomputed after a tile
+ * of the group has been marked dirty or the way the map is displayed has changed.
+ */
+struct SmallMapColourCache {
+	uint32 key;                  ///< Hash of the display settings the colours were computed with.
+	int zoom;                    ///< Number of tiles in each direction of a group.
+	uint offset_x;               ///< X coordinate of the first group, modulo #zoom.
+	uint offset_y;               ///< Y coordinate of the first group, modulo #zoom.
+	uint columns;                ///< Number of groups in x direction.
+	std::vector<uint32> colours; ///< Colours of the groups.
+	std::vector<bool> valid;     ///< Whether the colours of a group are up to date.
+	size_t refresh_pos;          ///< Next group to recompute in the periodic refresh.
+};
+
+/** Colours of the tile groups of the smallmap window, if there is one that can use them. */
+static SmallMapColourCache _smallmap_colour_cache;
+
 /**
  * Fills an array for the industries legends.
  */
@@ -856,7 +875,18 @@ void SmallMapWindow::DrawSmallMapColumn(void *dst, uint xc, uint yc, int pitch,
 		}
 		ta.ClampToMap(); // Clamp to map boundaries (may contain MP_VOID tiles!).
 
-		uint32 val = this->GetTileColours(ta);
+		uint32 val;
+		SmallMapColourCache &cache = _smallmap_colour_cache;
+		if (cache.valid.empty()) {
+			val = this->GetTileColours(ta);
+		} else {
+			size_t i = (yc - cache.offset_y) / this->zoom * cache.columns + (xc - cache.offset_x) / this->zoom;
+			if (!cache.valid[i]) {
+				cache.colours[i] = this->GetTileColours(ta);
+				cache.valid[i] = true;
+			}
+			val = cache.colours[i];
+		}
 		uint8 *val8 = (uint8 *)&val;
 		int idx = std::max(0, -start_pos);
 		for (int pos = std::max(0, start_pos); pos < end_pos; pos++) {
@@ -867,6 +897,99 @@ void SmallMapWindow::DrawSmallMapColumn(void *dst, uint xc, uint yc, int pitch,
 	} while (xc += this->zoom, yc += this->zoom, dst = blitter->MoveTo(dst, pitch, 0), --reps != 0);
 }
 
+/**
+ * Compute a hash of everything besides the map itself that affects the colours of the tiles.
+ * @return Hash of the display settings of the smallmap.
+ */
+uint32 SmallMapWindow::GetColourCacheKey() const
+{
+	uint32 key = this->map_type;
+	auto add = [&key](uint value) { key = (key ^ value) * 16777619U; };
+
+	add(_smallmap_show_heightmap);
+	add(_settings_client.gui.smallmap_land_colour);
+	add(SmallMapWindow::map_height_limit);
+	add(MapSizeX());
+	add(MapSizeY());
+	for (const LegendAndColour *tbl = _legend_table[this->map_type]; !tbl->end; ++tbl) {
+		add(tbl->colour);
+		add(tbl->company);
+		add(tbl->show_on_map);
+	}
+	return key;
+}
+
+/**
+ * Make the colour cache match the current way of displaying the map, or disable it when it cannot be used.
+ * @param tile_x X coordinate of a tile at the start of a group.
+ * @param tile_y Y coordinate of a tile at the start of a group.
+ */
+void SmallMapWindow::UpdateColourCache(int tile_x, int tile_y) const
+{
+	SmallMapColourCache &cache = _smallmap_colour_cache;
+
+	/* A group of a single tile is as fast to compute as to look up, and a blinking industry changes its colours all the time. */
+	if (this->zoom == 1 || (this->map_type == SMT_INDUSTRY && _smallmap_industry_highlight != INVALID_INDUSTRYTYPE)) {
+		cache.colours.clear();
+		cache.valid.clear();
+		return;
+	}
+
+	uint32 key = this->GetColourCacheKey();
+	uint offset_x = ((tile_x % this->zoom) + this->zoom) % this->zoom;
+	uint offset_y = ((tile_y % this->zoom) + this->zoom) % this->zoom;
+	if (!cache.valid.empty() && cache.key == key && cache.zoom == this->zoom && cache.offset_x == offset_x && cache.offset_y == offset_y) return;
+
+	cache.key = key;
+	cache.zoom = this->zoom;
+	cache.offset_x = offset_x;
+	cache.offset_y = offset_y;
+	cache.columns = CeilDiv(MapMaxX(), this->zoom);
+	size_t groups = (size_t)cache.columns * CeilDiv(MapMaxY(), this->zoom);
+	cache.colours.assign(groups, 0);
+	cache.valid.assign(groups, false);
+	cache.refresh_pos = 0;
+}
+
+/**
+ * Mark the smallmap colour of a tile as outdated.
+ * @param tile The tile that changed.
+ */
+void MarkSmallMapTileDirty(TileIndex tile)
+{
+	SmallMapColourCache &cache = _smallmap_colour_cache;
+	if (cache.valid.empty()) return;
+
+	uint x = TileX(tile);
+	uint y = TileY(tile);
+	if (x < cache.offset_x || y < cache.offset_y) return; // Never part of a drawn group.
+
+	size_t i = (y - cache.offset_y) / cache.zoom * cache.columns + (x - cache.offset_x) / cache.zoom;
+	if (i < cache.valid.size()) cache.valid[i] = false;
+}
+
+/**
+ * Get the colour of a tile for viewports that show a simplified map when zoomed out far.
+ * Routes get their colour of the "Routes" smallmap, all other tiles that of the "Vegetation" smallmap.
+ * @param tile The tile to get the colour of.
+ * @return The colour of the tile.
+ */
+uint8 GetSmallMapLodColour(TileIndex tile)
+{
+	TileType t = GetTileType(tile);
+	if (t == MP_TUNNELBRIDGE) {
+		switch (GetTunnelBridgeTransportType(tile)) {
+			case TRANSPORT_RAIL: t = MP_RAILWAY; break;
+			case TRANSPORT_ROAD: t = MP_ROAD;    break;
+			default:             t = MP_WATER;   break;
+		}
+	}
+
+	uint32 colours = (t == MP_RAILWAY || t == MP_ROAD || t == MP_STATION) ? GetSmallMapRoutesPixels(tile, t) : GetSmallMapVegetationPixels(tile, t);
+	/* Use one of the middle pixels, which show the route or the trees. */
+	return GB(colours, 8, 8);
+}
+
 /**
  * Adds vehicles to the smallmap.
  * @param dpi the part of the smallmap to be drawn into
@@ -982,6 +1105,8 @@ void SmallMapWindow::DrawSmallMap(DrawPixelInfo *dpi) const
 	int tile_x = this->scroll_x / (int)TILE_SIZE + tile.x;
 	int tile_y = this->scroll_y / (int)TILE_SIZE + tile.y;
 
+	this->UpdateColourCache(tile_x, tile_y);
+
 	void *ptr = blitter->MoveTo(dpi->dst_ptr, -dx - 4, 0);
 	int x = - dx - 4;
 	int y = 0;
@@ -1093,6 +1218,7 @@ SmallMapWindow::SmallMapWindow(WindowDesc *desc, int window_number) : Window(des
 
 SmallMapWindow::~SmallMapWindow()
 {
+	_smallmap_colour_cache = {};
 	delete this->overlay;
 	this->BreakIndustryChainLink();
 }
@@ -1593,6 +1719,14 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 	}
 	_smallmap_industry_highlight_state = !_smallmap_industry_highlight_state;
 
+	/* Not every change of the map marks its tile dirty, so gradually recompute all colours. */
+	SmallMapColourCache &cache = _smallmap_colour_cache;
+	if (!cache.valid.empty()) {
+		size_t end = std::min(cache.valid.size(), cache.refresh_pos + CeilDiv(cache.valid.size(), COLOUR_CACHE_REFRESH_STEPS));
+		std::fill(cache.valid.begin() + cache.refresh_pos, cache.valid.begin() + end, false);
+		cache.refresh_pos = end < cache.valid.size() ? end : 0;
+	}
+
 	this->refresh.SetInterval(_smallmap_industry_highlight != INVALID_INDUSTRYTYPE ? BLINK_PERIOD : FORCE_REFRESH_PERIOD);
 	this->SetDirty();
 }
@@ -26,6 +26,8 @@ void BuildIndustriesLegend();
 void ShowSmallMap();
 void BuildLandLegend();
 void BuildOwnerLegend();
+void MarkSmallMapTileDirty(TileIndex tile);
+uint8 GetSmallMapLodColour(TileIndex tile);
 
 /** Structure for holding relevant data for legends in small map */
 struct LegendAndColour {
@@ -68,6 +70,7 @@ protected:
 	static const uint INDUSTRY_MIN_NUMBER_OF_COLUMNS = 2; ///< Minimal number of columns in the #WID_SM_LEGEND widget for the #SMT_INDUSTRY legend.
 	static const uint FORCE_REFRESH_PERIOD = 930; ///< map is redrawn after that many milliseconds.
 	static const uint BLINK_PERIOD         = 450; ///< highlight blinking interval in milliseconds.
+	static const uint COLOUR_CACHE_REFRESH_STEPS = 16; ///< Number of refreshes in which all cached tile colours are recomputed.
 
 	uint min_number_of_columns;    ///< Minimal number of columns in legends.
 	uint min_number_of_fixed_rows; ///< Minimal number of rows in the legends for the fixed layouts only (all except #SMT_INDUSTRY).
@@ -166,6 +169,8 @@ protected:
 	void SetOverlayCargoMask();
 	void SetupWidgetData();
 	uint32 GetTileColours(const TileArea &ta) const;
+	uint32 GetColourCacheKey() const;
+	void UpdateColourCache(int tile_x, int tile_y) const;
 
 	int GetPositionOnLegend(Point pt);
 
@@ -206,6 +206,16 @@ public:
 		return false;
 	}
 
+	/**
+	 * Check if the list will be resorted by the next Sort call
+	 *
+	 * @return true if the resort bit is set
+	 */
+	bool IsResortPending() const
+	{
+		return (this->flags & VL_RESORT) != 0;
+	}
+
 	/**
 	 * Force a resort next Sort call
 	 *  Reset the resort timer if used too.
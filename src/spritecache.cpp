@@ -11,31 +11,39 @@
 #include "fileio_func.h"
 #include "spriteloader/grf.hpp"
 #include "gfx_func.h"
-#include "error.h"
 #include "zoom_func.h"
 #include "settings_type.h"
 #include "blitter/factory.hpp"
 #include "core/math_func.hpp"
 #include "core/mem_func.hpp"
 #include "video/video_driver.hpp"
+#include "fios.h"
+#include "3rdparty/md5/md5.h"
+#include "rev.h"
 
 #include "table/sprites.h"
-#include "table/strings.h"
 #include "table/palette_convert.h"
 
+#include <array>
+#include <bitset>
+
 #include "safeguards.h"
 
 /* Default of 4MB spritecache */
 uint _sprite_cache_size = 4;
+/* Whether encoded sprites are also stored on disk for the next start */
+bool _sprite_cache_on_disk = false;
 
 struct SpriteCache {
 	void *ptr;
 	size_t file_pos;
 	uint32 id;
+	uint lru_prev;       ///< Index of the next more recently used sprite, only valid when #in_lru is set.
+	uint lru_next;       ///< Index of the next less recently used sprite, only valid when #in_lru is set.
 	uint16 file_slot;
-	int16 lru;
 	SpriteType type;     ///< In some cases a single sprite is misused by two NewGRFs. Once as real sprite and once as recolour sprite. If the recolour sprite gets into the cache it might be drawn as real sprite which causes enormous trouble.
 	bool warned;         ///< True iff the user has been warned about incorrect use of this sprite
+	bool in_lru;         ///< True iff the cached data is part of the LRU list, i.e. it may be evicted.
 	byte container_ver;  ///< Container version of the GRF the sprite is from.
 };
 
@@ -73,18 +81,20 @@ static SpriteCache *AllocateSpriteCache(uint index)
 }
 
 
+/** Header of each allocation of sprite data, so the used memory can be accounted for when it is freed. */
 struct MemBlock {
 	size_t size;
 	byte data[];
 };
 
-static uint _sprite_lru_counter;
-static MemBlock *_spritecache_ptr;
-static uint _allocated_sprite_cache_size = 0;
-static int _compact_cache_counter;
+static const uint INVALID_LRU_INDEX = UINT_MAX;      ///< End marker of the LRU list.
+static uint _sprite_lru_head = INVALID_LRU_INDEX;    ///< Most recently used sprite.
+static uint _sprite_lru_tail = INVALID_LRU_INDEX;    ///< Least recently used sprite, i.e. the first to be evicted.
+static SpriteCacheStats _sprite_cache_stats = {};    ///< Memory usage and effectiveness of the sprite cache.
 
-static void CompactSpriteCache();
 static void *AllocSprite(size_t mem_req);
+static void FreeSprite(void *ptr);
+static void DeleteEntryFromSpriteCache(uint item);
 
 /**
  * Skip the given amount of sprite graphics data.
@@ -599,10 +609,10 @@ bool LoadNextSprite(int load_index, byte file_slot, uint file_sprite_id, byte co
 	}
 
 	SpriteCache *sc = AllocateSpriteCache(load_index);
+	if (sc->ptr != nullptr) DeleteEntryFromSpriteCache(load_index);
 	sc->file_slot = file_slot;
 	sc->file_pos = file_pos;
 	sc->ptr = data;
-	sc->lru = 0;
 	sc->id = file_sprite_id;
 	sc->type = type;
 	sc->warned = false;
@@ -617,6 +627,7 @@ void DupSprite(SpriteID old_spr, SpriteID new_spr)
 	SpriteCache *scnew = AllocateSpriteCache(new_spr); // may reallocate: so put it first
 	SpriteCache *scold = GetSpriteCache(old_spr);
 
+	if (scnew->ptr != nullptr) DeleteEntryFromSpriteCache(new_spr);
 	scnew->file_slot = scold->file_slot;
 	scnew->file_pos = scold->file_pos;
 	scnew->ptr = nullptr;
@@ -627,188 +638,336 @@ void DupSprite(SpriteID old_spr, SpriteID new_spr)
 }
 
 /**
- * S_FREE_MASK is used to mask-out lower bits of MemBlock::size
- * If they are non-zero, the block is free.
- * S_FREE_MASK has to ensure MemBlock is correctly aligned -
- * it means 8B (S_FREE_MASK == 7) on 64bit systems!
+ * Make the given sprite the most recently used one.
+ * @param item Sprite with cached data that is not yet in the LRU list.
  */
-static const size_t S_FREE_MASK = sizeof(size_t) - 1;
-
-/* to make sure nobody adds things to MemBlock without checking S_FREE_MASK first */
-static_assert(sizeof(MemBlock) == sizeof(size_t));
-/* make sure it's a power of two */
-static_assert((sizeof(size_t) & (sizeof(size_t) - 1)) == 0);
-
-static inline MemBlock *NextBlock(MemBlock *block)
+static void LinkSpriteLRU(uint item)
 {
-	return (MemBlock*)((byte*)block + (block->size & ~S_FREE_MASK));
+	SpriteCache *sc = GetSpriteCache(item);
+	assert(!sc->in_lru);
+
+	sc->in_lru = true;
+	sc->lru_prev = INVALID_LRU_INDEX;
+	sc->lru_next = _sprite_lru_head;
+	if (_sprite_lru_head != INVALID_LRU_INDEX) {
+		GetSpriteCache(_sprite_lru_head)->lru_prev = item;
+	} else {
+		_sprite_lru_tail = item;
+	}
+	_sprite_lru_head = item;
 }
 
-static size_t GetSpriteCacheUsage()
+/**
+ * Remove the given sprite from the LRU list.
+ * @param item Sprite that is in the LRU list.
+ */
+static void UnlinkSpriteLRU(uint item)
 {
-	size_t tot_size = 0;
-	MemBlock *s;
+	SpriteCache *sc = GetSpriteCache(item);
+	assert(sc->in_lru);
 
-	for (s = _spritecache_ptr; s->size != 0; s = NextBlock(s)) {
-		if (!(s->size & S_FREE_MASK)) tot_size += s->size;
+	if (sc->lru_prev != INVALID_LRU_INDEX) {
+		GetSpriteCache(sc->lru_prev)->lru_next = sc->lru_next;
+	} else {
+		_sprite_lru_head = sc->lru_next;
 	}
-
-	return tot_size;
+	if (sc->lru_next != INVALID_LRU_INDEX) {
+		GetSpriteCache(sc->lru_next)->lru_prev = sc->lru_prev;
+	} else {
+		_sprite_lru_tail = sc->lru_prev;
+	}
+	sc->in_lru = false;
 }
 
-
-void IncreaseSpriteLRU()
+/**
+ * Delete a single entry from the sprite cache.
+ * @param item Entry to delete.
+ */
+static void DeleteEntryFromSpriteCache(uint item)
 {
-	/* Increase all LRU values */
-	if (_sprite_lru_counter > 16384) {
-		SpriteID i;
+	SpriteCache *sc = GetSpriteCache(item);
+	if (sc->in_lru) UnlinkSpriteLRU(item);
 
-		DEBUG(sprite, 3, "Fixing lru %u, inuse=" PRINTF_SIZE, _sprite_lru_counter, GetSpriteCacheUsage());
+	FreeSprite(sc->ptr);
+	sc->ptr = nullptr;
+}
 
-		for (i = 0; i != _spritecache_items; i++) {
-			SpriteCache *sc = GetSpriteCache(i);
-			if (sc->ptr != nullptr) {
-				if (sc->lru >= 0) {
-					sc->lru = -1;
-				} else if (sc->lru != -32768) {
-					sc->lru--;
-				}
-			}
-		}
-		_sprite_lru_counter = 0;
-	}
+static void *AllocSprite(size_t mem_req)
+{
+	mem_req += sizeof(MemBlock);
 
-	/* Compact sprite cache every now and then. */
-	if (++_compact_cache_counter >= 740) {
-		CompactSpriteCache();
-		_compact_cache_counter = 0;
+	/* Evict the least recently used sprites until the new one fits the budget.
+	 * Recolour sprites are never in the LRU list, so they can not be evicted. */
+	while (_sprite_cache_stats.used + mem_req > _sprite_cache_stats.budget && _sprite_lru_tail != INVALID_LRU_INDEX) {
+		DeleteEntryFromSpriteCache(_sprite_lru_tail);
+		_sprite_cache_stats.evictions++;
 	}
+
+	MemBlock *s = (MemBlock *)MallocT<byte>(mem_req);
+	s->size = mem_req;
+	_sprite_cache_stats.used += mem_req;
+	return s->data;
 }
 
 /**
- * Called when holes in the sprite cache should be removed.
- * That is accomplished by moving the cached data.
+ * Free memory allocated by #AllocSprite.
+ * @param ptr The sprite data.
  */
-static void CompactSpriteCache()
+static void FreeSprite(void *ptr)
 {
-	MemBlock *s;
-
-	DEBUG(sprite, 3, "Compacting sprite cache, inuse=" PRINTF_SIZE, GetSpriteCacheUsage());
+	MemBlock *s = (MemBlock *)ptr - 1;
+	assert(_sprite_cache_stats.used >= s->size);
+	_sprite_cache_stats.used -= s->size;
+	free(s);
+}
 
-	for (s = _spritecache_ptr; s->size != 0;) {
-		if (s->size & S_FREE_MASK) {
-			MemBlock *next = NextBlock(s);
-			MemBlock temp;
-			SpriteID i;
+/** Key of the encoded data of a sprite in the on-disk sprite cache. */
+typedef std::array<uint8, 16> DiskSpriteKey;
 
-			/* Since free blocks are automatically coalesced, this should hold true. */
-			assert(!(next->size & S_FREE_MASK));
+/** Location of the encoded data of a sprite in the on-disk sprite cache. */
+struct DiskSpriteEntry {
+	long offset;        ///< Position of the data in the file.
+	uint32 size;        ///< Size of the data.
+	uint8 checksum[16]; ///< MD5 checksum of the data.
+};
 
-			/* If the next block is the sentinel block, we can safely return */
-			if (next->size == 0) break;
+static const char DISK_SPRITE_CACHE_MAGIC[8] = { 'O', 'T', 'T', 'D', 'S', 'P', 'C', '2' }; ///< Start of the on-disk sprite cache, including its version.
+static const long DISK_SPRITE_CACHE_MAX_SIZE = 1024 * 1024 * 1024; ///< The on-disk sprite cache is started over when it would grow beyond this size.
 
-			/* Locate the sprite belonging to the next pointer. */
-			for (i = 0; GetSpriteCache(i)->ptr != next->data; i++) {
-				assert(i != _spritecache_items);
-			}
+static FILE *_disk_sprite_cache = nullptr;                          ///< The opened on-disk sprite cache, if any.
+static std::string _disk_sprite_cache_header;                       ///< Header of the opened on-disk sprite cache.
+static long _disk_sprite_cache_end;                                 ///< End of the last complete entry in the on-disk sprite cache.
+static std::map<DiskSpriteKey, DiskSpriteEntry> _disk_sprite_index; ///< Entries of the on-disk sprite cache.
+static uint8 _disk_sprite_file_md5[MAX_FILE_SLOTS][16];             ///< MD5 checksum of the file in each file slot.
+static std::bitset<MAX_FILE_SLOTS> _disk_sprite_file_md5_valid;     ///< Whether #_disk_sprite_file_md5 is known for a file slot.
 
-			GetSpriteCache(i)->ptr = s->data; // Adjust sprite array entry
-			/* Swap this and the next block */
-			temp = *s;
-			memmove(s, next, next->size);
-			s = NextBlock(s);
-			*s = temp;
+/**
+ * Get the header the on-disk sprite cache should start with. Sprites are only
+ * reused by the same revision of the game with the same blitter, as otherwise
+ * the encoding of the sprites may differ.
+ * @return The header.
+ */
+static std::string GetDiskSpriteCacheHeader()
+{
+	Blitter *blitter = BlitterFactory::GetCurrentBlitter();
+
+	std::string header(DISK_SPRITE_CACHE_MAGIC, sizeof(DISK_SPRITE_CACHE_MAGIC));
+	header += _openttd_revision;
+	header += '\0';
+	header += blitter->GetName();
+	header += '\0';
+	header += std::to_string(blitter->GetSpriteFormatVersion());
+	header += '\0';
+	return header;
+}
 
-			/* Coalesce free blocks */
-			while (NextBlock(s)->size & S_FREE_MASK) {
-				s->size += NextBlock(s)->size & ~S_FREE_MASK;
-			}
-		} else {
-			s = NextBlock(s);
-		}
-	}
+/** Stop using the on-disk sprite cache. */
+static void CloseDiskSpriteCache()
+{
+	FioFCloseFile(_disk_sprite_cache);
+	_disk_sprite_cache = nullptr;
+	_disk_sprite_index.clear();
 }
 
 /**
- * Delete a single entry from the sprite cache.
- * @param item Entry to delete.
+ * Start the on-disk sprite cache over, removing all of its entries.
+ * @return True if the file could be started over, otherwise it is no longer used.
  */
-static void DeleteEntryFromSpriteCache(uint item)
+static bool ResetDiskSpriteCache()
 {
-	/* Mark the block as free (the block must be in use) */
-	MemBlock *s = (MemBlock*)GetSpriteCache(item)->ptr - 1;
-	assert(!(s->size & S_FREE_MASK));
-	s->size |= S_FREE_MASK;
-	GetSpriteCache(item)->ptr = nullptr;
-
-	/* And coalesce adjacent free blocks */
-	for (s = _spritecache_ptr; s->size != 0; s = NextBlock(s)) {
-		if (s->size & S_FREE_MASK) {
-			while (NextBlock(s)->size & S_FREE_MASK) {
-				s->size += NextBlock(s)->size & ~S_FREE_MASK;
-			}
-		}
+	_disk_sprite_index.clear();
+	_disk_sprite_cache_header = GetDiskSpriteCacheHeader();
+	_disk_sprite_cache_end = (long)_disk_sprite_cache_header.size();
+
+	if (!FioTruncateFile(_disk_sprite_cache, 0) || fseek(_disk_sprite_cache, 0, SEEK_SET) != 0 ||
+			fwrite(_disk_sprite_cache_header.data(), _disk_sprite_cache_header.size(), 1, _disk_sprite_cache) != 1) {
+		DEBUG(sprite, 0, "Cannot reset the sprite cache file, no longer using it");
+		CloseDiskSpriteCache();
+		return false;
 	}
+	return true;
 }
 
-static void DeleteEntryFromSpriteCache()
+/**
+ * Open the on-disk sprite cache and read the index of its entries.
+ * A file that is of another version, revision or blitter is started over.
+ * A file that is in use by another instance of the game is not used at all.
+ */
+static void OpenDiskSpriteCache()
 {
-	uint best = UINT_MAX;
-	int cur_lru;
+	std::string filename = _personal_dir + "sprites.cache";
 
-	DEBUG(sprite, 3, "DeleteEntryFromSpriteCache, inuse=" PRINTF_SIZE, GetSpriteCacheUsage());
+	FILE *f = FioFOpenFile(filename, "r+b", NO_DIRECTORY);
+	if (f == nullptr) f = FioFOpenFile(filename, "w+b", NO_DIRECTORY);
+	if (f == nullptr) {
+		DEBUG(sprite, 0, "Cannot open sprite cache file %s", filename.c_str());
+		return;
+	}
 
-	cur_lru = 0xffff;
-	for (SpriteID i = 0; i != _spritecache_items; i++) {
-		SpriteCache *sc = GetSpriteCache(i);
-		if (sc->type != ST_RECOLOUR && sc->ptr != nullptr && sc->lru < cur_lru) {
-			cur_lru = sc->lru;
-			best = i;
-		}
+	/* Entries are appended while playing, so two instances cannot share the file. */
+	if (!FioLockFile(f)) {
+		DEBUG(sprite, 1, "Sprite cache file %s is in use by another instance, not using it", filename.c_str());
+		FioFCloseFile(f);
+		return;
+	}
+
+	_disk_sprite_cache = f;
+
+	std::string header = GetDiskSpriteCacheHeader();
+	std::string file_header(header.size(), '\0');
+	if (fread(&file_header[0], file_header.size(), 1, f) != 1 || file_header != header) {
+		ResetDiskSpriteCache();
+		return;
 	}
 
-	/* Display an error message and die, in case we found no sprite at all.
-	 * This shouldn't really happen, unless all sprites are locked. */
-	if (best == UINT_MAX) error("Out of sprite memory");
+	fseek(f, 0, SEEK_END);
+	long file_size = ftell(f);
 
-	DeleteEntryFromSpriteCache(best);
+	/* Each entry is its key, the size of the data, the checksum of the data and
+	 * the data itself. A partly written entry at the end is ignored. */
+	long pos = (long)header.size();
+	fseek(f, pos, SEEK_SET);
+
+	DiskSpriteKey key;
+	DiskSpriteEntry entry;
+	while (fread(key.data(), key.size(), 1, f) == 1 && fread(&entry.size, sizeof(entry.size), 1, f) == 1 &&
+			fread(entry.checksum, sizeof(entry.checksum), 1, f) == 1) {
+		entry.offset = pos + (long)(key.size() + sizeof(entry.size) + sizeof(entry.checksum));
+		if (entry.size > (uint32)(file_size - entry.offset)) break;
+
+		_disk_sprite_index[key] = entry;
+		pos = entry.offset + entry.size;
+		if (fseek(f, pos, SEEK_SET) != 0) break;
+	}
+
+	DEBUG(sprite, 1, "Read %u entries from sprite cache file %s", (uint)_disk_sprite_index.size(), filename.c_str());
+
+	_disk_sprite_cache_header = header;
+	_disk_sprite_cache_end = pos;
 }
 
-static void *AllocSprite(size_t mem_req)
+/**
+ * Get the key of a sprite in the on-disk sprite cache.
+ * It covers everything the encoded sprite depends on: the contents of the GRF,
+ * the sprite within it and the settings and blitter used for encoding it.
+ * @param sc The sprite.
+ * @param type Type of the sprite.
+ * @return The key.
+ */
+static DiskSpriteKey GetDiskSpriteKey(const SpriteCache *sc, SpriteType type)
 {
-	mem_req += sizeof(MemBlock);
+	if (!_disk_sprite_file_md5_valid[sc->file_slot]) {
+		FioCalcFileMD5(sc->file_slot, _disk_sprite_file_md5[sc->file_slot]);
+		_disk_sprite_file_md5_valid.set(sc->file_slot);
+	}
 
-	/* Align this to correct boundary. This also makes sure at least one
-	 * bit is not used, so we can use it for other things. */
-	mem_req = Align(mem_req, S_FREE_MASK + 1);
+	Md5 checksum;
+	checksum.Append(_disk_sprite_file_md5[sc->file_slot], sizeof(_disk_sprite_file_md5[sc->file_slot]));
 
-	for (;;) {
-		MemBlock *s;
+	uint64 file_pos = sc->file_pos;
+	checksum.Append(&file_pos, sizeof(file_pos));
 
-		for (s = _spritecache_ptr; s->size != 0; s = NextBlock(s)) {
-			if (s->size & S_FREE_MASK) {
-				size_t cur_size = s->size & ~S_FREE_MASK;
+	byte params[] = {
+		(byte)type, sc->container_ver, (byte)_palette_remap_grf[sc->file_slot],
+		(byte)_settings_client.gui.zoom_min, (byte)_settings_client.gui.zoom_max, (byte)_settings_client.gui.sprite_zoom_min,
+	};
+	checksum.Append(params, sizeof(params));
 
-				/* Is the block exactly the size we need or
-				 * big enough for an additional free block? */
-				if (cur_size == mem_req ||
-						cur_size >= mem_req + sizeof(MemBlock)) {
-					/* Set size and in use */
-					s->size = mem_req;
+	const char *blitter = BlitterFactory::GetCurrentBlitter()->GetName();
+	checksum.Append(blitter, strlen(blitter));
 
-					/* Do we need to inject a free block too? */
-					if (cur_size != mem_req) {
-						NextBlock(s)->size = (cur_size - mem_req) | S_FREE_MASK;
-					}
+	DiskSpriteKey key;
+	checksum.Finish(key.data());
+	return key;
+}
 
-					return s->data;
-				}
-			}
-		}
+/**
+ * Read the encoded data of a sprite from the on-disk sprite cache.
+ * @param key Key of the sprite.
+ * @return The sprite data, or \c nullptr if the sprite is not in the on-disk cache or its data is damaged.
+ */
+static void *ReadSpriteFromDisk(const DiskSpriteKey &key)
+{
+	auto it = _disk_sprite_index.find(key);
+	if (it == _disk_sprite_index.end()) return nullptr;
+
+	const DiskSpriteEntry &entry = it->second;
+	void *ptr = AllocSprite(entry.size);
+	bool valid = fseek(_disk_sprite_cache, entry.offset, SEEK_SET) == 0 && fread(ptr, entry.size, 1, _disk_sprite_cache) == 1;
+
+	if (valid) {
+		uint8 checksum[16];
+		Md5 md5;
+		md5.Append(ptr, entry.size);
+		md5.Finish(checksum);
+		valid = memcmp(checksum, entry.checksum, sizeof(checksum)) == 0;
+		if (!valid) DEBUG(sprite, 1, "Damaged entry in the sprite cache file, ignoring it");
+	}
 
-		/* Reached sentinel, but no block found yet. Delete some old entry. */
-		DeleteEntryFromSpriteCache();
+	if (!valid) {
+		FreeSprite(ptr);
+		_disk_sprite_index.erase(it);
+		return nullptr;
 	}
+	return ptr;
+}
+
+/**
+ * Append the encoded data of a sprite to the on-disk sprite cache.
+ * @param key Key of the sprite.
+ * @param ptr The sprite data, as allocated by #AllocSprite.
+ */
+static void WriteSpriteToDisk(const DiskSpriteKey &key, const void *ptr)
+{
+	DiskSpriteEntry entry;
+	entry.size = (uint32)(((const MemBlock *)ptr - 1)->size - sizeof(MemBlock));
+
+	long header_size = (long)(key.size() + sizeof(entry.size) + sizeof(entry.checksum));
+	if (_disk_sprite_cache_end + header_size + (long)entry.size > DISK_SPRITE_CACHE_MAX_SIZE) {
+		/* Entries of other NewGRFs, settings and blitters pile up; rather start over than keep them forever. */
+		DEBUG(sprite, 1, "Sprite cache file is full, starting it over");
+		if (!ResetDiskSpriteCache()) return;
+		if ((long)_disk_sprite_cache_header.size() + header_size + (long)entry.size > DISK_SPRITE_CACHE_MAX_SIZE) return;
+	}
+	entry.offset = _disk_sprite_cache_end + header_size;
+
+	Md5 md5;
+	md5.Append(ptr, entry.size);
+	md5.Finish(entry.checksum);
+
+	if (fseek(_disk_sprite_cache, _disk_sprite_cache_end, SEEK_SET) != 0 ||
+			fwrite(key.data(), key.size(), 1, _disk_sprite_cache) != 1 ||
+			fwrite(&entry.size, sizeof(entry.size), 1, _disk_sprite_cache) != 1 ||
+			fwrite(entry.checksum, sizeof(entry.checksum), 1, _disk_sprite_cache) != 1 ||
+			fwrite(ptr, entry.size, 1, _disk_sprite_cache) != 1) {
+		DEBUG(sprite, 0, "Cannot write to the sprite cache file, no longer using it");
+		CloseDiskSpriteCache();
+		return;
+	}
+
+	_disk_sprite_index[key] = entry;
+	_disk_sprite_cache_end = entry.offset + entry.size;
+}
+
+/**
+ * Load a sprite into the sprite cache, from the on-disk sprite cache when it is
+ * there, otherwise from its GRF while also adding it to the on-disk sprite cache.
+ * @param sc          Location of sprite.
+ * @param id          Sprite number.
+ * @param sprite_type Type of sprite.
+ * @return Read sprite data.
+ */
+static void *LoadSpriteIntoCache(const SpriteCache *sc, SpriteID id, SpriteType sprite_type)
+{
+	if (_disk_sprite_cache == nullptr || sprite_type == ST_MAPGEN) return ReadSprite(sc, id, sprite_type, AllocSprite, nullptr);
+
+	DiskSpriteKey key = GetDiskSpriteKey(sc, sprite_type);
+	void *ptr = ReadSpriteFromDisk(key);
+	if (ptr != nullptr) return ptr;
+
+	ptr = ReadSprite(sc, id, sprite_type, AllocSprite, nullptr);
+	if (ptr != nullptr && _disk_sprite_cache != nullptr) WriteSpriteToDisk(key, ptr);
+	return ptr;
 }
 
 /**
@@ -892,11 +1051,19 @@ void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator, S
 	if (allocator == nullptr && encoder == nullptr) {
 		/* Load sprite into/from spritecache */
 
-		/* Update LRU */
-		sc->lru = ++_sprite_lru_counter;
-
-		/* Load the sprite, if it is not loaded, yet */
-		if (sc->ptr == nullptr) sc->ptr = ReadSprite(sc, sprite, type, AllocSprite, nullptr);
+		if (sc->ptr == nullptr) {
+			/* Load the sprite, if it is not loaded, yet */
+			_sprite_cache_stats.misses++;
+			sc->ptr = LoadSpriteIntoCache(sc, sprite, type);
+			if (sc->ptr != nullptr) LinkSpriteLRU(sprite);
+		} else if (sc->in_lru) {
+			/* Update LRU */
+			_sprite_cache_stats.hits++;
+			if (_sprite_lru_head != sprite) {
+				UnlinkSpriteLRU(sprite);
+				LinkSpriteLRU(sprite);
+			}
+		}
 
 		return sc->ptr;
 	} else {
@@ -908,65 +1075,34 @@ void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator, S
 
 static void GfxInitSpriteCache()
 {
-	/* initialize sprite cache heap */
+	/* Sprites are allocated on demand, so only the budget of the cache needs to be set. */
 	int bpp = BlitterFactory::GetCurrentBlitter()->GetScreenDepth();
-	uint target_size = (bpp > 0 ? _sprite_cache_size * bpp / 8 : 1) * 1024 * 1024;
-
-	/* Remember 'target_size' from the previous allocation attempt, so we do not try to reach the target_size multiple times in case of failure. */
-	static uint last_alloc_attempt = 0;
-
-	if (_spritecache_ptr == nullptr || (_allocated_sprite_cache_size != target_size && target_size != last_alloc_attempt)) {
-		delete[] reinterpret_cast<byte *>(_spritecache_ptr);
-
-		last_alloc_attempt = target_size;
-		_allocated_sprite_cache_size = target_size;
-
-		do {
-			try {
-				/* Try to allocate 50% more to make sure we do not allocate almost all available. */
-				_spritecache_ptr = reinterpret_cast<MemBlock *>(new byte[_allocated_sprite_cache_size + _allocated_sprite_cache_size / 2]);
-			} catch (std::bad_alloc &) {
-				_spritecache_ptr = nullptr;
-			}
-
-			if (_spritecache_ptr != nullptr) {
-				/* Allocation succeeded, but we wanted less. */
-				delete[] reinterpret_cast<byte *>(_spritecache_ptr);
-				_spritecache_ptr = reinterpret_cast<MemBlock *>(new byte[_allocated_sprite_cache_size]);
-			} else if (_allocated_sprite_cache_size < 2 * 1024 * 1024) {
-				usererror("Cannot allocate spritecache");
-			} else {
-				/* Try again to allocate half. */
-				_allocated_sprite_cache_size >>= 1;
-			}
-		} while (_spritecache_ptr == nullptr);
-
-		if (_allocated_sprite_cache_size != target_size) {
-			DEBUG(misc, 0, "Not enough memory to allocate %d MiB of spritecache. Spritecache was reduced to %d MiB.", target_size / 1024 / 1024, _allocated_sprite_cache_size / 1024 / 1024);
-
-			ErrorMessageData msg(STR_CONFIG_ERROR_OUT_OF_MEMORY, STR_CONFIG_ERROR_SPRITECACHE_TOO_BIG);
-			msg.SetDParam(0, target_size);
-			msg.SetDParam(1, _allocated_sprite_cache_size);
-			ScheduleErrorMessage(msg);
-		}
-	}
-
-	/* A big free block */
-	_spritecache_ptr->size = (_allocated_sprite_cache_size - sizeof(MemBlock)) | S_FREE_MASK;
-	/* Sentinel block (identified by size == 0) */
-	NextBlock(_spritecache_ptr)->size = 0;
+	uint64 target_size = (uint64)(bpp > 0 ? _sprite_cache_size * bpp / 8 : 1) * 1024 * 1024;
+	_sprite_cache_stats.budget = (size_t)std::min<uint64>(target_size, SIZE_MAX);
 }
 
 void GfxInitSpriteMem()
 {
 	GfxInitSpriteCache();
 
-	/* Reset the spritecache 'pool' */
+	/* Release all sprite data and reset the spritecache 'pool' */
+	for (uint i = 0; i != _spritecache_items; i++) {
+		if (GetSpriteCache(i)->ptr != nullptr) DeleteEntryFromSpriteCache(i);
+	}
+	assert(_sprite_lru_head == INVALID_LRU_INDEX && _sprite_lru_tail == INVALID_LRU_INDEX);
+
+	/* The file slots are about to be filled with (other) GRFs. */
+	_disk_sprite_file_md5_valid.reset();
+	if (_sprite_cache_on_disk && _disk_sprite_cache == nullptr) {
+		OpenDiskSpriteCache();
+	} else if (_disk_sprite_cache != nullptr && _disk_sprite_cache_header != GetDiskSpriteCacheHeader()) {
+		/* The blitter changed, so the stored sprites cannot be used anymore. */
+		ResetDiskSpriteCache();
+	}
+
 	free(_spritecache);
 	_spritecache_items = 0;
 	_spritecache = nullptr;
-
-	_compact_cache_counter = 0;
 }
 
 /**
@@ -975,13 +1111,19 @@ void GfxInitSpriteMem()
  */
 void GfxClearSpriteCache()
 {
-	/* Clear sprite ptr for all cached items */
-	for (uint i = 0; i != _spritecache_items; i++) {
-		SpriteCache *sc = GetSpriteCache(i);
-		if (sc->type != ST_RECOLOUR && sc->ptr != nullptr) DeleteEntryFromSpriteCache(i);
-	}
+	/* Clear sprite ptr for all cached items; recolour sprites are not in the LRU list. */
+	while (_sprite_lru_tail != INVALID_LRU_INDEX) DeleteEntryFromSpriteCache(_sprite_lru_tail);
 
 	VideoDriver::GetInstance()->ClearSystemSprites();
 }
 
+/**
+ * Get the memory usage and hit/miss statistics of the sprite cache.
+ * @return The statistics.
+ */
+const SpriteCacheStats &GetSpriteCacheStats()
+{
+	return _sprite_cache_stats;
+}
+
 /* static */ ReusableBuffer<SpriteLoader::CommonPixel> SpriteLoader::Sprite::buffer[ZOOM_LVL_COUNT];
@@ -22,7 +22,17 @@ struct Sprite {
 	byte data[];   ///< Sprite data.
 };
 
+/** Memory usage and effectiveness of the sprite cache. */
+struct SpriteCacheStats {
+	size_t used;      ///< Number of bytes allocated for cached sprites.
+	size_t budget;    ///< Number of bytes the cache may use before sprites are evicted.
+	uint64 hits;      ///< Number of lookups that found the sprite in the cache.
+	uint64 misses;    ///< Number of lookups that had to load the sprite.
+	uint64 evictions; ///< Number of sprites removed from the cache to make room for others.
+};
+
 extern uint _sprite_cache_size;
+extern bool _sprite_cache_on_disk;
 
 typedef void *AllocatorProc(size_t size);
 
@@ -51,7 +61,7 @@ static inline const byte *GetNonSprite(SpriteID sprite, SpriteType type)
 
 void GfxInitSpriteMem();
 void GfxClearSpriteCache();
-void IncreaseSpriteLRU();
+const SpriteCacheStats &GetSpriteCacheStats();
 
 void ReadGRFSpriteOffsets(byte container_version);
 size_t GetGRFSpriteOffset(uint32 id);
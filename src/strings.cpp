@@ -35,6 +35,9 @@
 #include "game/game_text.hpp"
 #include "network/network_content_gui.h"
 #include <stack>
+#include <array>
+#include <list>
+#include <unordered_map>
 
 #include "table/strings.h"
 #include "table/control_codes.h"
@@ -55,6 +58,43 @@ static uint64 _global_string_params_data[20];     ///< Global array of string pa
 static WChar _global_string_params_type[20];      ///< Type of parameters stored in #_global_string_params
 StringParameters _global_string_params(_global_string_params_data, 20, _global_string_params_type);
 
+/** Key of a formatted string in the string cache. */
+struct StringCacheKey {
+	StringID string;                                                   ///< The formatted string.
+	std::array<uint64, lengthof(_global_string_params_data)> params; ///< All global string parameters at the time of formatting.
+
+	bool operator==(const StringCacheKey &other) const
+	{
+		return this->string == other.string && this->params == other.params;
+	}
+};
+
+/** Hash function for #StringCacheKey. */
+struct StringCacheHash {
+	size_t operator()(const StringCacheKey &key) const
+	{
+		uint64 h = key.string;
+		for (uint64 p : key.params) h = (h ^ p) * 0x100000001B3ULL;
+		return (size_t)(h ^ (h >> 32));
+	}
+};
+
+/** List of the keys of the cached strings, from most to least recently used. */
+typedef std::list<const StringCacheKey *> StringCacheLRU;
+
+/** Formatted string in the string cache. */
+struct StringCacheItem {
+	std::string text;               ///< The formatted string.
+	StringCacheLRU::iterator lru_pos; ///< Position of the item in the least recently used list.
+};
+
+static const size_t MAX_STRING_CACHE_SIZE = 4096; ///< Number of formatted strings kept in the string cache.
+
+static std::unordered_map<StringCacheKey, StringCacheItem, StringCacheHash> _string_cache; ///< Results of #GetString that depend only on the string parameters.
+static StringCacheLRU _string_cache_lru;     ///< Least recently used order of #_string_cache.
+static StringCacheStats _string_cache_stats; ///< Effectiveness of the string cache.
+static bool _string_uncacheable = false;     ///< Set while formatting when the result depends on more than its parameters, e.g. the name of a vehicle.
+
 /** Reset the type array. */
 void StringParameters::ClearTypeInformation()
 {
@@ -210,10 +250,10 @@ static bool _scan_for_gender_data = false;  ///< Are we scanning for the gender
 const char *GetStringPtr(StringID string)
 {
 	switch (GetStringTab(string)) {
-		case TEXT_TAB_GAMESCRIPT_START: return GetGameStringPtr(GetStringIndex(string));
+		case TEXT_TAB_GAMESCRIPT_START: _string_uncacheable = true; return GetGameStringPtr(GetStringIndex(string));
 		/* 0xD0xx and 0xD4xx IDs have been converted earlier. */
 		case TEXT_TAB_OLD_NEWGRF: NOT_REACHED();
-		case TEXT_TAB_NEWGRF_START: return GetGRFStringPtr(GetStringIndex(string));
+		case TEXT_TAB_NEWGRF_START: _string_uncacheable = true; return GetGRFStringPtr(GetStringIndex(string));
 		default: return _langpack.offsets[_langpack.langtab_start[GetStringTab(string)] + GetStringIndex(string)];
 	}
 }
@@ -238,12 +278,14 @@ char *GetStringWithArgs(char *buffr, StringID string, StringParameters *args, co
 	switch (tab) {
 		case TEXT_TAB_TOWN:
 			if (index >= 0xC0 && !game_script) {
+				_string_uncacheable = true;
 				return GetSpecialTownNameString(buffr, index - 0xC0, args->GetInt32(), last);
 			}
 			break;
 
 		case TEXT_TAB_SPECIAL:
 			if (index >= 0xE4 && !game_script) {
+				_string_uncacheable = true;
 				return GetSpecialNameString(buffr, index - 0xE4, args, last);
 			}
 			break;
@@ -256,12 +298,14 @@ char *GetStringWithArgs(char *buffr, StringID string, StringParameters *args, co
 			break;
 
 		case TEXT_TAB_GAMESCRIPT_START:
+			_string_uncacheable = true;
 			return FormatString(buffr, GetGameStringPtr(index), args, last, case_index, true);
 
 		case TEXT_TAB_OLD_NEWGRF:
 			NOT_REACHED();
 
 		case TEXT_TAB_NEWGRF_START:
+			_string_uncacheable = true;
 			return FormatString(buffr, GetGRFStringPtr(index), args, last, case_index);
 
 		default:
@@ -278,11 +322,78 @@ char *GetStringWithArgs(char *buffr, StringID string, StringParameters *args, co
 	return FormatString(buffr, GetStringPtr(string), args, last, case_index);
 }
 
+/**
+ * Remove all formatted strings from the string cache. This has to be called
+ * whenever the language, the locale settings or the currencies change.
+ */
+void InvalidateStringCache()
+{
+	_string_cache.clear();
+	_string_cache_lru.clear();
+}
+
+/**
+ * Get the effectiveness of the cache of formatted strings.
+ * @return Size and hit counts of the string cache.
+ */
+StringCacheStats GetStringCacheStats()
+{
+	StringCacheStats stats = _string_cache_stats;
+	stats.size = _string_cache.size();
+	return stats;
+}
+
+/**
+ * Get a parsed string with all special stringcodes replaced by the global string parameters.
+ * Strings that depend only on their parameters, the language and the locale settings
+ * are remembered, so drawing them again does not need to format them again.
+ * @param buffr  Pointer to a string buffer where the formatted string should be written to.
+ * @param string The string to format.
+ * @param last   Pointer just past the end of \a buffr.
+ * @return       Pointer to the final zero byte of the formatted string.
+ */
 char *GetString(char *buffr, StringID string, const char *last)
 {
 	_global_string_params.ClearTypeInformation();
 	_global_string_params.offset = 0;
-	return GetStringWithArgs(buffr, string, &_global_string_params, last);
+
+	StringCacheKey key;
+	key.string = string;
+	std::copy(std::begin(_global_string_params_data), std::end(_global_string_params_data), key.params.begin());
+
+	auto it = _string_cache.find(key);
+	if (it != _string_cache.end() && it->second.text.size() < (size_t)(last - buffr)) {
+		_string_cache_stats.hits++;
+		_string_cache_lru.splice(_string_cache_lru.begin(), _string_cache_lru, it->second.lru_pos);
+		const std::string &text = it->second.text;
+		MemCpyT(buffr, text.c_str(), text.size() + 1);
+		return buffr + text.size();
+	}
+
+	bool outer_uncacheable = _string_uncacheable;
+	_string_uncacheable = false;
+	char *end = GetStringWithArgs(buffr, string, &_global_string_params, last);
+	bool cacheable = !_string_uncacheable && end < last; // The result might be truncated when the buffer is full.
+	_string_uncacheable = outer_uncacheable || _string_uncacheable;
+
+	if (!cacheable) {
+		_string_cache_stats.uncacheable++;
+		return end;
+	}
+
+	_string_cache_stats.misses++;
+	auto res = _string_cache.try_emplace(key);
+	if (res.second) {
+		res.first->second.text.assign(buffr, end);
+		_string_cache_lru.push_front(&res.first->first);
+		res.first->second.lru_pos = _string_cache_lru.begin();
+
+		if (_string_cache.size() > MAX_STRING_CACHE_SIZE) {
+			_string_cache.erase(_string_cache.find(*_string_cache_lru.back()));
+			_string_cache_lru.pop_back();
+		}
+	}
+	return end;
 }
 
 
@@ -781,6 +892,43 @@ uint ConvertDisplaySpeedToKmhishSpeed(uint speed)
 {
 	return _units_velocity[_settings_game.locale.units_velocity].c.FromDisplay(speed * 16, true, 10);
 }
+
+/**
+ * Check whether the text a string control code produces depends only on the string parameters, the language and the locale settings.
+ * @param b The string control code.
+ * @return False when the text also depends on e.g. the name of a game object or a NewGRF.
+ */
+static bool IsCacheableControlCode(WChar b)
+{
+	if (SCC_NEWGRF_FIRST <= b && b <= SCC_NEWGRF_LAST) return false;
+
+	switch (b) {
+		case SCC_ENCODED:
+		case SCC_RAW_STRING_POINTER:
+		case SCC_CARGO_TINY:
+		case SCC_CARGO_SHORT:
+		case SCC_CARGO_LONG:
+		case SCC_CARGO_LIST:
+		case SCC_COMPANY_NAME:
+		case SCC_COMPANY_NUM:
+		case SCC_DEPOT_NAME:
+		case SCC_ENGINE_NAME:
+		case SCC_GROUP_NAME:
+		case SCC_INDUSTRY_NAME:
+		case SCC_PRESIDENT_NAME:
+		case SCC_STATION_NAME:
+		case SCC_TOWN_NAME:
+		case SCC_WAYPOINT_NAME:
+		case SCC_VEHICLE_NAME:
+		case SCC_SIGN_NAME:
+		case SCC_STATION_FEATURES:
+			return false;
+
+		default:
+			return true;
+	}
+}
+
 /**
  * Parse most format codes within a string and write the result to a buffer.
  * @param buff    The buffer to write the final string to.
@@ -796,6 +944,7 @@ static char *FormatString(char *buff, const char *str_arg, StringParameters *arg
 	/* When there is no array with types there is no need to do a dry run. */
 	if (args->HasTypeInformation() && !dry_run) {
 		if (UsingNewGRFTextStack()) {
+			_string_uncacheable = true;
 			/* Values from the NewGRF text stack are only copied to the normal
 			 * argv array at the time they are encountered. That means that if
 			 * another string command references a value later in the string it
@@ -824,6 +973,8 @@ static char *FormatString(char *buff, const char *str_arg, StringParameters *arg
 		if (str_stack.empty()) break;
 		const char *&str = str_stack.top();
 
+		if (!IsCacheableControlCode(b)) _string_uncacheable = true;
+
 		if (SCC_NEWGRF_FIRST <= b && b <= SCC_NEWGRF_LAST) {
 			/* We need to pass some stuff as it might be modified; oh boy. */
 			//todo: should argve be passed here too?
@@ -1788,6 +1939,7 @@ bool ReadLanguagePack(const LanguageMetadata *lang)
 	_langpack.langtab_start = tab_start;
 
 	_current_language = lang;
+	InvalidateStringCache();
 	_current_text_dir = (TextDirection)_current_language->text_dir;
 	const char *c_file = strrchr(_current_language->file, PATHSEPCHAR) + 1;
 	_config_language_file = c_file;
@@ -171,7 +171,17 @@ public:
 };
 extern StringParameters _global_string_params;
 
+/** Effectiveness of the cache of formatted strings. */
+struct StringCacheStats {
+	size_t size;        ///< Number of cached strings.
+	uint64 hits;        ///< Number of strings found in the cache.
+	uint64 misses;      ///< Number of strings that had to be formatted and were added to the cache.
+	uint64 uncacheable; ///< Number of strings that had to be formatted and could not be cached.
+};
+
 char *GetString(char *buffr, StringID string, const char *last);
+StringCacheStats GetStringCacheStats();
+void InvalidateStringCache();
 char *GetStringWithArgs(char *buffr, StringID string, StringParameters *args, const char *last, uint case_index = 0, bool game_script = false);
 const char *GetStringPtr(StringID string);
 
@@ -1688,7 +1688,7 @@ void UpdateLevelCrossing(TileIndex tile, bool sound)
 	assert(IsLevelCrossingTile(tile));
 
 	/* reserved || train on crossing || train approaching crossing */
-	bool new_state = HasCrossingReservation(tile) || HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum) || TrainApproachingCrossing(tile);
+	bool new_state = HasCrossingReservation(tile) || (CountVehiclesOnPos(tile, VEH_TRAIN) != 0 && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) || TrainApproachingCrossing(tile);
 
 	if (new_state != IsCrossingBarred(tile)) {
 		if (new_state && sound) {
@@ -12,6 +12,7 @@
 
 #include "bridge_map.h"
 #include "tunnel_map.h"
+#include "pbs_cache.h"
 
 
 /**
@@ -106,6 +107,7 @@ static inline void SetTunnelBridgeReservation(TileIndex t, bool b)
 	assert(IsTileType(t, MP_TUNNELBRIDGE));
 	assert(GetTunnelBridgeTransportType(t) == TRANSPORT_RAIL);
 	SB(_m[t].m5, 4, 1, b ? 1 : 0);
+	InvalidateReservationCache();
 }
 
 /**
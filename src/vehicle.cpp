@@ -56,31 +56,6 @@
 
 #include "safeguards.h"
 
-/* Number of bits in the hash to use from each vehicle coord */
-static const uint GEN_HASHX_BITS = 6;
-static const uint GEN_HASHY_BITS = 6;
-
-/* Size of each hash bucket */
-static const uint GEN_HASHX_BUCKET_BITS = 7;
-static const uint GEN_HASHY_BUCKET_BITS = 6;
-
-/* Compute hash for vehicle coord */
-#define GEN_HASHX(x)    GB((x), GEN_HASHX_BUCKET_BITS + ZOOM_LVL_SHIFT, GEN_HASHX_BITS)
-#define GEN_HASHY(y)   (GB((y), GEN_HASHY_BUCKET_BITS + ZOOM_LVL_SHIFT, GEN_HASHY_BITS) << GEN_HASHX_BITS)
-#define GEN_HASH(x, y) (GEN_HASHY(y) + GEN_HASHX(x))
-
-/* Maximum size until hash repeats */
-static const int GEN_HASHX_SIZE = 1 << (GEN_HASHX_BUCKET_BITS + GEN_HASHX_BITS + ZOOM_LVL_SHIFT);
-static const int GEN_HASHY_SIZE = 1 << (GEN_HASHY_BUCKET_BITS + GEN_HASHY_BITS + ZOOM_LVL_SHIFT);
-
-/* Increments to reach next bucket in hash table */
-static const int GEN_HASHX_INC = 1;
-static const int GEN_HASHY_INC = 1 << GEN_HASHX_BITS;
-
-/* Mask to wrap-around buckets */
-static const uint GEN_HASHX_MASK =  (1 << GEN_HASHX_BITS) - 1;
-static const uint GEN_HASHY_MASK = ((1 << GEN_HASHY_BITS) - 1) << GEN_HASHX_BITS;
-
 VehicleID _new_vehicle_id;
 uint _returned_refit_capacity;        ///< Stores the capacity after a refit operation.
 uint16 _returned_mail_refit_capacity; ///< Stores the mail capacity after a refit operation (Aircraft only).
@@ -365,32 +340,82 @@ byte VehicleRandomBits()
 	return GB(Random(), 0, 8);
 }
 
-/* Size of the hash, 6 = 64 x 64, 7 = 128 x 128. Larger sizes will (in theory) reduce hash
- * lookup times at the expense of memory usage. */
-const int HASH_BITS = 7;
-const int HASH_SIZE = 1 << HASH_BITS;
-const int HASH_MASK = HASH_SIZE - 1;
-const int TOTAL_HASH_SIZE = 1 << (HASH_BITS * 2);
-const int TOTAL_HASH_MASK = TOTAL_HASH_SIZE - 1;
+/* The tile hash covers the whole map without repeating. Each bucket holds the vehicles of a
+ * square chunk of tiles; the chunks are made larger on big maps only, to keep the memory usage
+ * of the hash at most 1 << MAX_TILE_HASH_BITS pointers. */
+static const uint MAX_TILE_HASH_BITS = 20;
 
-/* Resolution of the hash, 0 = 1*1 tile, 1 = 2*2 tiles, 2 = 4*4 tiles, etc.
- * Profiling results show that 0 is fastest. */
-const int HASH_RES = 0;
+static uint _tile_hash_res;     ///< Resolution of the hash, 0 = 1*1 tile, 1 = 2*2 tiles, 2 = 4*4 tiles, etc.
+static uint _tile_hash_bits_x;  ///< Number of bits of the hash in the x direction.
+static uint _tile_hash_bits_y;  ///< Number of bits of the hash in the y direction.
 
-static Vehicle *_vehicle_tile_hash[TOTAL_HASH_SIZE];
+static std::vector<Vehicle *> _vehicle_tile_hash;
+/* Number of train (VEH_TRAIN) and road vehicle (VEH_ROAD) parts in each bucket of the tile hash.
+ * These are updated whenever a vehicle enters or leaves a bucket, so checking whether a tile
+ * can be occupied by a train or road vehicle does not need to walk the bucket's chain. */
+static_assert(VEH_TRAIN == 0 && VEH_ROAD == 1);
+static std::vector<uint> _vehicle_tile_count[VEH_ROAD + 1];
+
+/**
+ * Get the hash column of a tile's x coordinate.
+ * @param x The x coordinate of the tile.
+ * @return The column in the tile hash.
+ */
+static inline uint GetTileHashX(uint x)
+{
+	return GB(x, _tile_hash_res, _tile_hash_bits_x);
+}
 
-static Vehicle *VehicleFromTileHash(int xl, int yl, int xu, int yu, void *data, VehicleFromPosProc *proc, bool find_first)
+/**
+ * Get the hash row of a tile's y coordinate.
+ * @param y The y coordinate of the tile.
+ * @return The row in the tile hash.
+ */
+static inline uint GetTileHashY(uint y)
 {
-	for (int y = yl; ; y = (y + (1 << HASH_BITS)) & (HASH_MASK << HASH_BITS)) {
-		for (int x = xl; ; x = (x + 1) & HASH_MASK) {
-			Vehicle *v = _vehicle_tile_hash[(x + y) & TOTAL_HASH_MASK];
+	return GB(y, _tile_hash_res, _tile_hash_bits_y);
+}
+
+/**
+ * Get the bucket of the tile hash for the given row and column.
+ * @param x The column in the tile hash.
+ * @param y The row in the tile hash.
+ * @return The head of the bucket's vehicle chain.
+ */
+static inline Vehicle **GetTileHashBucket(uint x, uint y)
+{
+	return &_vehicle_tile_hash[(y << _tile_hash_bits_x) + x];
+}
+
+/**
+ * Get the area of the tile hash that has to be scanned to find all vehicles close to a location.
+ * @param x    The X location on the map
+ * @param y    The Y location on the map
+ * @param[out] xl The first column to scan.
+ * @param[out] yl The first row to scan.
+ * @param[out] xu The last column to scan.
+ * @param[out] yu The last row to scan.
+ */
+static void GetTileHashAreaXY(int x, int y, uint *xl, uint *yl, uint *xu, uint *yu)
+{
+	const int COLL_DIST = 6;
+
+	*xl = GetTileHashX(Clamp((x - COLL_DIST) / (int)TILE_SIZE, 0, (int)MapMaxX()));
+	*xu = GetTileHashX(Clamp((x + COLL_DIST) / (int)TILE_SIZE, 0, (int)MapMaxX()));
+	*yl = GetTileHashY(Clamp((y - COLL_DIST) / (int)TILE_SIZE, 0, (int)MapMaxY()));
+	*yu = GetTileHashY(Clamp((y + COLL_DIST) / (int)TILE_SIZE, 0, (int)MapMaxY()));
+}
+
+static Vehicle *VehicleFromTileHash(uint xl, uint yl, uint xu, uint yu, void *data, VehicleFromPosProc *proc, bool find_first)
+{
+	for (uint y = yl; y <= yu; y++) {
+		for (uint x = xl; x <= xu; x++) {
+			Vehicle *v = *GetTileHashBucket(x, y);
 			for (; v != nullptr; v = v->hash_tile_next) {
 				Vehicle *a = proc(v, data);
 				if (find_first && a != nullptr) return a;
 			}
-			if (x == xu) break;
 		}
-		if (y == yu) break;
 	}
 
 	return nullptr;
@@ -410,13 +435,9 @@ static Vehicle *VehicleFromTileHash(int xl, int yl, int xu, int yu, void *data,
  */
 static Vehicle *VehicleFromPosXY(int x, int y, void *data, VehicleFromPosProc *proc, bool find_first)
 {
-	const int COLL_DIST = 6;
-
 	/* Hash area to scan is from xl,yl to xu,yu */
-	int xl = GB((x - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
-	int xu = GB((x + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
-	int yl = GB((y - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
-	int yu = GB((y + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
+	uint xl, yl, xu, yu;
+	GetTileHashAreaXY(x, y, &xl, &yl, &xu, &yu);
 
 	return VehicleFromTileHash(xl, yl, xu, yu, data, proc, find_first);
 }
@@ -456,6 +477,55 @@ bool HasVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc)
 	return VehicleFromPosXY(x, y, data, proc, true) != nullptr;
 }
 
+/**
+ * Count the train or road vehicle parts that #FindVehicleOnPosXY could find near a location.
+ * As a bucket of the hash covers at least a whole tile, this is an upper bound;
+ * when it is zero the search for these vehicles can be skipped altogether.
+ * @param x      The X location on the map
+ * @param y      The Y location on the map
+ * @param type   The type of vehicles to count, either #VEH_TRAIN or #VEH_ROAD.
+ * @param ignore Vehicle part not to count, or \c nullptr.
+ * @return The number of vehicle parts in the searched area.
+ */
+uint CountVehiclesOnPosXY(int x, int y, VehicleType type, const Vehicle *ignore)
+{
+	assert(type == VEH_TRAIN || type == VEH_ROAD);
+
+	uint xl, yl, xu, yu;
+	GetTileHashAreaXY(x, y, &xl, &yl, &xu, &yu);
+
+	uint count = 0;
+	for (uint hy = yl; hy <= yu; hy++) {
+		for (uint hx = xl; hx <= xu; hx++) {
+			count += _vehicle_tile_count[type][(hy << _tile_hash_bits_x) + hx];
+		}
+	}
+
+	if (ignore != nullptr && ignore->type == type && ignore->hash_tile_current != nullptr) {
+		size_t index = ignore->hash_tile_current - _vehicle_tile_hash.data();
+		uint hx = GB(index, 0, _tile_hash_bits_x);
+		uint hy = (uint)(index >> _tile_hash_bits_x);
+		if (IsInsideMM(hx, xl, xu + 1) && IsInsideMM(hy, yl, yu + 1)) count--;
+	}
+
+	return count;
+}
+
+/**
+ * Count the train or road vehicle parts that #FindVehicleOnPos could find on a tile.
+ * As a bucket of the hash may cover more than one tile, this is an upper bound;
+ * when it is zero the search for these vehicles can be skipped altogether.
+ * @param tile The location on the map
+ * @param type The type of vehicles to count, either #VEH_TRAIN or #VEH_ROAD.
+ * @return The number of vehicle parts in the tile's bucket.
+ */
+uint CountVehiclesOnPos(TileIndex tile, VehicleType type)
+{
+	assert(type == VEH_TRAIN || type == VEH_ROAD);
+
+	return _vehicle_tile_count[type][(GetTileHashY(TileY(tile)) << _tile_hash_bits_x) + GetTileHashX(TileX(tile))];
+}
+
 /**
  * Helper function for FindVehicleOnPos/HasVehicleOnPos.
  * @note Do not call this function directly!
@@ -468,10 +538,7 @@ bool HasVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc)
  */
 static Vehicle *VehicleFromPos(TileIndex tile, void *data, VehicleFromPosProc *proc, bool find_first)
 {
-	int x = GB(TileX(tile), HASH_RES, HASH_BITS);
-	int y = GB(TileY(tile), HASH_RES, HASH_BITS) << HASH_BITS;
-
-	Vehicle *v = _vehicle_tile_hash[(x + y) & TOTAL_HASH_MASK];
+	Vehicle *v = *GetTileHashBucket(GetTileHashX(TileX(tile)), GetTileHashY(TileY(tile)));
 	for (; v != nullptr; v = v->hash_tile_next) {
 		if (v->tile != tile) continue;
 
@@ -600,6 +667,8 @@ static Vehicle *EnsureNoTrainOnTrackProc(Vehicle *v, void *data)
  */
 CommandCost EnsureNoTrainOnTrackBits(TileIndex tile, TrackBits track_bits)
 {
+	if (CountVehiclesOnPos(tile, VEH_TRAIN) == 0) return CommandCost();
+
 	/* Value v is not safe in MP games, however, it is used to generate a local
 	 * error message only (which may be different for different machines).
 	 * Such a message does not affect MP synchronisation.
@@ -617,9 +686,7 @@ static void UpdateVehicleTileHash(Vehicle *v, bool remove)
 	if (remove) {
 		new_hash = nullptr;
 	} else {
-		int x = GB(TileX(v->tile), HASH_RES, HASH_BITS);
-		int y = GB(TileY(v->tile), HASH_RES, HASH_BITS) << HASH_BITS;
-		new_hash = &_vehicle_tile_hash[(x + y) & TOTAL_HASH_MASK];
+		new_hash = GetTileHashBucket(GetTileHashX(TileX(v->tile)), GetTileHashY(TileY(v->tile)));
 	}
 
 	if (old_hash == new_hash) return;
@@ -628,6 +695,7 @@ static void UpdateVehicleTileHash(Vehicle *v, bool remove)
 	if (old_hash != nullptr) {
 		if (v->hash_tile_next != nullptr) v->hash_tile_next->hash_tile_prev = v->hash_tile_prev;
 		*v->hash_tile_prev = v->hash_tile_next;
+		if (v->type <= VEH_ROAD) _vehicle_tile_count[v->type][old_hash - _vehicle_tile_hash.data()]--;
 	}
 
 	/* Insert vehicle at beginning of the new position in the hash table */
@@ -636,20 +704,73 @@ static void UpdateVehicleTileHash(Vehicle *v, bool remove)
 		if (v->hash_tile_next != nullptr) v->hash_tile_next->hash_tile_prev = &v->hash_tile_next;
 		v->hash_tile_prev = new_hash;
 		*new_hash = v;
+		if (v->type <= VEH_ROAD) _vehicle_tile_count[v->type][new_hash - _vehicle_tile_hash.data()]++;
 	}
 
 	/* Remember current hash position */
 	v->hash_tile_current = new_hash;
 }
 
-static Vehicle *_vehicle_viewport_hash[1 << (GEN_HASHX_BITS + GEN_HASHY_BITS)];
+/* The viewport hash covers the whole map as seen in the viewports without repeating. Each bucket
+ * holds the vehicles whose top left corner lies in a rectangle of the viewport coordinates; the
+ * rectangles are made larger on big maps only, to keep the memory usage of the hash at most
+ * 1 << MAX_VIEWPORT_HASH_BITS pointers. The buckets are grouped into blocks that count their
+ * vehicles, so views that are zoomed out far can skip the empty parts of the map a block at a time. */
+static const uint MAX_VIEWPORT_HASH_BITS = 18;
+static const uint MIN_VIEWPORT_HASH_BUCKET_BITS_X = 7 + ZOOM_LVL_SHIFT; ///< Minimum width of a bucket, 128 pixels at the normal zoom level.
+static const uint MIN_VIEWPORT_HASH_BUCKET_BITS_Y = 6 + ZOOM_LVL_SHIFT; ///< Minimum height of a bucket, 64 pixels at the normal zoom level.
+static const uint VIEWPORT_HASH_BLOCK_BITS = 3;                        ///< A block is 8*8 buckets.
 
-static void UpdateVehicleViewportHash(Vehicle *v, int x, int y, int old_x, int old_y)
+static int _viewport_hash_left;              ///< Viewport x coordinate of the left of the hash.
+static int _viewport_hash_top;               ///< Viewport y coordinate of the top of the hash.
+static uint _viewport_hash_bucket_bits_x;    ///< Number of bits of the width of a bucket.
+static uint _viewport_hash_bucket_bits_y;    ///< Number of bits of the height of a bucket.
+static uint _viewport_hash_columns;          ///< Number of columns of buckets, a multiple of the block size.
+static uint _viewport_hash_rows;             ///< Number of rows of buckets, a multiple of the block size.
+
+static std::vector<Vehicle *> _vehicle_viewport_hash;
+/* Number of vehicles in each block of the viewport hash. */
+static std::vector<uint> _vehicle_viewport_block_count;
+
+/**
+ * Get the hash column of a viewport x coordinate.
+ * Coordinates outside of the map end up in the first or last column.
+ * @param x The x coordinate in the viewport.
+ * @return The column in the viewport hash.
+ */
+static inline uint GetViewportHashX(int x)
 {
-	Vehicle **old_hash, **new_hash;
+	return Clamp((x - _viewport_hash_left) >> _viewport_hash_bucket_bits_x, 0, (int)_viewport_hash_columns - 1);
+}
 
-	new_hash = (x == INVALID_COORD) ? nullptr : &_vehicle_viewport_hash[GEN_HASH(x, y)];
-	old_hash = (old_x == INVALID_COORD) ? nullptr : &_vehicle_viewport_hash[GEN_HASH(old_x, old_y)];
+/**
+ * Get the hash row of a viewport y coordinate.
+ * Coordinates outside of the map end up in the first or last row.
+ * @param y The y coordinate in the viewport.
+ * @return The row in the viewport hash.
+ */
+static inline uint GetViewportHashY(int y)
+{
+	return Clamp((y - _viewport_hash_top) >> _viewport_hash_bucket_bits_y, 0, (int)_viewport_hash_rows - 1);
+}
+
+/**
+ * Get the number of vehicles in the block of a bucket of the viewport hash.
+ * @param bucket The bucket in the viewport hash.
+ * @return The vehicle count of the bucket's block.
+ */
+static inline uint &GetViewportHashBlockCount(Vehicle **bucket)
+{
+	size_t index = bucket - _vehicle_viewport_hash.data();
+	uint x = (uint)(index % _viewport_hash_columns) >> VIEWPORT_HASH_BLOCK_BITS;
+	uint y = (uint)(index / _viewport_hash_columns) >> VIEWPORT_HASH_BLOCK_BITS;
+	return _vehicle_viewport_block_count[y * (_viewport_hash_columns >> VIEWPORT_HASH_BLOCK_BITS) + x];
+}
+
+static void UpdateVehicleViewportHash(Vehicle *v, int x, int y)
+{
+	Vehicle **old_hash = v->hash_viewport_current;
+	Vehicle **new_hash = (x == INVALID_COORD) ? nullptr : &_vehicle_viewport_hash[GetViewportHashY(y) * _viewport_hash_columns + GetViewportHashX(x)];
 
 	if (old_hash == new_hash) return;
 
@@ -657,6 +778,7 @@ static void UpdateVehicleViewportHash(Vehicle *v, int x, int y, int old_x, int o
 	if (old_hash != nullptr) {
 		if (v->hash_viewport_next != nullptr) v->hash_viewport_next->hash_viewport_prev = v->hash_viewport_prev;
 		*v->hash_viewport_prev = v->hash_viewport_next;
+		GetViewportHashBlockCount(old_hash)--;
 	}
 
 	/* insert into hash table? */
@@ -665,14 +787,53 @@ static void UpdateVehicleViewportHash(Vehicle *v, int x, int y, int old_x, int o
 		if (v->hash_viewport_next != nullptr) v->hash_viewport_next->hash_viewport_prev = &v->hash_viewport_next;
 		v->hash_viewport_prev = new_hash;
 		*new_hash = v;
+		GetViewportHashBlockCount(new_hash)++;
 	}
+
+	v->hash_viewport_current = new_hash;
 }
 
+/**
+ * Clear the vehicle hashes and fit the tile hash to the current map size.
+ * All vehicles have to be re-added by updating their position afterwards.
+ */
 void ResetVehicleHash()
 {
-	for (Vehicle *v : Vehicle::Iterate()) { v->hash_tile_current = nullptr; }
-	memset(_vehicle_viewport_hash, 0, sizeof(_vehicle_viewport_hash));
-	memset(_vehicle_tile_hash, 0, sizeof(_vehicle_tile_hash));
+	for (Vehicle *v : Vehicle::Iterate()) {
+		v->hash_tile_current = nullptr;
+		v->hash_viewport_current = nullptr;
+	}
+
+	/* Use the finest resolution for which the hash still fits in its maximum size. */
+	_tile_hash_res = 0;
+	while (MapLogX() + MapLogY() - 2 * _tile_hash_res > MAX_TILE_HASH_BITS) _tile_hash_res++;
+	_tile_hash_bits_x = MapLogX() - _tile_hash_res;
+	_tile_hash_bits_y = MapLogY() - _tile_hash_res;
+
+	_vehicle_tile_hash.clear();
+	_vehicle_tile_hash.resize((size_t)1 << (_tile_hash_bits_x + _tile_hash_bits_y), nullptr);
+	for (auto &count : _vehicle_tile_count) count.assign(_vehicle_tile_hash.size(), 0);
+
+	/* The map spans this area of the viewport coordinates, see RemapCoords; above it there is room for the highest mountains. */
+	int width = (MapSizeX() + MapSizeY()) * TILE_SIZE * 2 * ZOOM_LVL_BASE;
+	int height = ((MapSizeX() + MapSizeY()) * TILE_SIZE + MAX_TILE_HEIGHT * TILE_HEIGHT) * ZOOM_LVL_BASE;
+	_viewport_hash_left = -(int)(MapSizeX() * TILE_SIZE * 2 * ZOOM_LVL_BASE);
+	_viewport_hash_top = -(int)(MAX_TILE_HEIGHT * TILE_HEIGHT * ZOOM_LVL_BASE);
+
+	_viewport_hash_bucket_bits_x = MIN_VIEWPORT_HASH_BUCKET_BITS_X;
+	_viewport_hash_bucket_bits_y = MIN_VIEWPORT_HASH_BUCKET_BITS_Y;
+	for (;;) {
+		_viewport_hash_columns = Align(CeilDiv(width, 1 << _viewport_hash_bucket_bits_x), 1 << VIEWPORT_HASH_BLOCK_BITS);
+		_viewport_hash_rows = Align(CeilDiv(height, 1 << _viewport_hash_bucket_bits_y), 1 << VIEWPORT_HASH_BLOCK_BITS);
+		if (_viewport_hash_columns * _viewport_hash_rows <= 1U << MAX_VIEWPORT_HASH_BITS) break;
+		_viewport_hash_bucket_bits_x++;
+		_viewport_hash_bucket_bits_y++;
+	}
+
+	_vehicle_viewport_hash.clear();
+	_vehicle_viewport_hash.resize(_viewport_hash_columns * _viewport_hash_rows, nullptr);
+	_vehicle_viewport_block_count.clear();
+	_vehicle_viewport_block_count.resize((_viewport_hash_columns * _viewport_hash_rows) >> (2 * VIEWPORT_HASH_BLOCK_BITS), 0);
 }
 
 void ResetVehicleColourMap()
@@ -880,7 +1041,7 @@ Vehicle::~Vehicle()
 	delete v;
 
 	UpdateVehicleTileHash(this, true);
-	UpdateVehicleViewportHash(this, INVALID_COORD, 0, this->sprite_cache.old_coord.left, this->sprite_cache.old_coord.top);
+	UpdateVehicleViewportHash(this, INVALID_COORD, 0);
 	DeleteVehicleNews(this->index, INVALID_STRING_ID);
 	DeleteNewGRFInspectWindow(GetGrfSpecFeature(this->type), this->index);
 }
@@ -941,6 +1102,9 @@ void CallVehicleTicks()
 {
 	_vehicles_to_autoreplace.clear();
 
+	/* Reserved paths might have changed since the last tick in ways that are not tracked, e.g. by a company merger. */
+	InvalidateReservationCache();
+
 	RunVehicleDayProc();
 
 	{
@@ -1103,6 +1267,47 @@ static void DoDrawVehicle(const Vehicle *v)
 	EndSpriteCombine();
 }
 
+/**
+ * Call a function for the vehicles in the buckets of the viewport hash that cover an area of the viewports.
+ * The vehicles themselves are not checked; they can be outside of the area.
+ * @param l    Left of the area.
+ * @param r    Right of the area.
+ * @param t    Top of the area.
+ * @param b    Bottom of the area.
+ * @param proc The function to call for each vehicle.
+ */
+template <typename Tproc>
+static void ForAllVehiclesInViewportHash(int l, int r, int t, int b, Tproc proc)
+{
+	if (_vehicle_viewport_hash.empty()) return;
+
+	/* The hash area to scan */
+	const uint xl = GetViewportHashX(l);
+	const uint xu = GetViewportHashX(r);
+	const uint yl = GetViewportHashY(t);
+	const uint yu = GetViewportHashY(b);
+
+	const uint block_columns = _viewport_hash_columns >> VIEWPORT_HASH_BLOCK_BITS;
+	for (uint block_y = yl >> VIEWPORT_HASH_BLOCK_BITS; block_y <= yu >> VIEWPORT_HASH_BLOCK_BITS; block_y++) {
+		for (uint block_x = xl >> VIEWPORT_HASH_BLOCK_BITS; block_x <= xu >> VIEWPORT_HASH_BLOCK_BITS; block_x++) {
+			/* Skip the buckets of blocks without any vehicles. */
+			if (_vehicle_viewport_block_count[block_y * block_columns + block_x] == 0) continue;
+
+			uint first_x = std::max(xl, block_x << VIEWPORT_HASH_BLOCK_BITS);
+			uint last_x = std::min(xu, ((block_x + 1) << VIEWPORT_HASH_BLOCK_BITS) - 1);
+			uint first_y = std::max(yl, block_y << VIEWPORT_HASH_BLOCK_BITS);
+			uint last_y = std::min(yu, ((block_y + 1) << VIEWPORT_HASH_BLOCK_BITS) - 1);
+			for (uint y = first_y; y <= last_y; y++) {
+				for (uint x = first_x; x <= last_x; x++) {
+					for (const Vehicle *v = _vehicle_viewport_hash[y * _viewport_hash_columns + x]; v != nullptr; v = v->hash_viewport_next) {
+						proc(v);
+					}
+				}
+			}
+		}
+	}
+}
+
 /**
  * Add the vehicle sprites that should be drawn at a part of the screen.
  * @param dpi Rectangle being drawn.
@@ -1119,79 +1324,71 @@ void ViewportAddVehicles(DrawPixelInfo *dpi)
 	const int xb = MAX_VEHICLE_PIXEL_X * ZOOM_LVL_BASE;
 	const int yb = MAX_VEHICLE_PIXEL_Y * ZOOM_LVL_BASE;
 
-	/* The hash area to scan */
-	int xl, xu, yl, yu;
-
-	if (dpi->width + xb < GEN_HASHX_SIZE) {
-		xl = GEN_HASHX(l - xb);
-		xu = GEN_HASHX(r);
-	} else {
-		/* scan whole hash row */
-		xl = 0;
-		xu = GEN_HASHX_MASK;
-	}
-
-	if (dpi->height + yb < GEN_HASHY_SIZE) {
-		yl = GEN_HASHY(t - yb);
-		yu = GEN_HASHY(b);
-	} else {
-		/* scan whole column */
-		yl = 0;
-		yu = GEN_HASHY_MASK;
-	}
-
-	for (int y = yl;; y = (y + GEN_HASHY_INC) & GEN_HASHY_MASK) {
-		for (int x = xl;; x = (x + GEN_HASHX_INC) & GEN_HASHX_MASK) {
-			const Vehicle *v = _vehicle_viewport_hash[x + y]; // already masked & 0xFFF
-
-			while (v != nullptr) {
-
-				if (!(v->vehstatus & VS_HIDDEN) &&
-					l <= v->coord.right + xb &&
-					t <= v->coord.bottom + yb &&
-					r >= v->coord.left - xb &&
-					b >= v->coord.top - yb)
-				{
+	ForAllVehiclesInViewportHash(l - xb, r, t - yb, b, [&](const Vehicle *v) {
+		if (!(v->vehstatus & VS_HIDDEN) &&
+			l <= v->coord.right + xb &&
+			t <= v->coord.bottom + yb &&
+			r >= v->coord.left - xb &&
+			b >= v->coord.top - yb)
+		{
+			/*
+			 * This vehicle can potentially be drawn as part of this viewport and
+			 * needs to be revalidated, as the sprite may not be correct.
+			 */
+			if (v->sprite_cache.revalidate_before_draw) {
+				VehicleSpriteSeq seq;
+				v->GetImage(v->direction, EIT_ON_MAP, &seq);
+
+				if (seq.IsValid() && v->sprite_cache.sprite_seq != seq) {
+					v->sprite_cache.sprite_seq = seq;
 					/*
-					 * This vehicle can potentially be drawn as part of this viewport and
-					 * needs to be revalidated, as the sprite may not be correct.
+					 * A sprite change may also result in a bounding box change,
+					 * so we need to update the bounding box again before we
+					 * check to see if the vehicle should be drawn. Note that
+					 * we can't interfere with the viewport hash at this point,
+					 * so we keep the original hash on the assumption there will
+					 * not be a significant change in the top and left coordinates
+					 * of the vehicle.
 					 */
-					if (v->sprite_cache.revalidate_before_draw) {
-						VehicleSpriteSeq seq;
-						v->GetImage(v->direction, EIT_ON_MAP, &seq);
-
-						if (seq.IsValid() && v->sprite_cache.sprite_seq != seq) {
-							v->sprite_cache.sprite_seq = seq;
-							/*
-							 * A sprite change may also result in a bounding box change,
-							 * so we need to update the bounding box again before we
-							 * check to see if the vehicle should be drawn. Note that
-							 * we can't interfere with the viewport hash at this point,
-							 * so we keep the original hash on the assumption there will
-							 * not be a significant change in the top and left coordinates
-							 * of the vehicle.
-							 */
-							v->UpdateBoundingBoxCoordinates(false);
-
-						}
-
-						v->sprite_cache.revalidate_before_draw = false;
-					}
+					v->UpdateBoundingBoxCoordinates(false);
 
-					if (l <= v->coord.right &&
-						t <= v->coord.bottom &&
-						r >= v->coord.left &&
-						b >= v->coord.top) DoDrawVehicle(v);
 				}
 
-				v = v->hash_viewport_next;
+				v->sprite_cache.revalidate_before_draw = false;
 			}
 
-			if (x == xu) break;
+			if (l <= v->coord.right &&
+				t <= v->coord.bottom &&
+				r >= v->coord.left &&
+				b >= v->coord.top) DoDrawVehicle(v);
 		}
+	});
+}
 
-		if (y == yu) break;
-	}
+/**
+ * Draw the vehicles at a part of the screen as dots, for viewports that show a simplified map.
+ * The dots are drawn directly on #_cur_dpi, which has to be the unzoomed version of \a dpi.
+ * @param dpi Rectangle being drawn, in viewport coordinates.
+ */
+void ViewportDrawVehicleMarkers(const DrawPixelInfo *dpi)
+{
+	const int l = dpi->left;
+	const int r = dpi->left + dpi->width;
+	const int t = dpi->top;
+	const int b = dpi->top + dpi->height;
+
+	/* The hash holds vehicles by their top left corner, while the dots are drawn in their middle. */
+	const int xb = MAX_VEHICLE_PIXEL_X * ZOOM_LVL_BASE;
+	const int yb = MAX_VEHICLE_PIXEL_Y * ZOOM_LVL_BASE;
+
+	ForAllVehiclesInViewportHash(l - xb, r, t - yb, b, [&](const Vehicle *v) {
+		if (v->type == VEH_EFFECT) return;
+		if (v->vehstatus & (VS_HIDDEN | VS_UNCLICKABLE)) return;
+
+		int x = UnScaleByZoomLower((v->coord.left + v->coord.right) / 2, dpi->zoom);
+		int y = UnScaleByZoomLower((v->coord.top + v->coord.bottom) / 2, dpi->zoom);
+		GfxFillRect(x, y, x + 1, y + 1, PC_WHITE);
+	});
 }
 
 /**
@@ -1642,7 +1839,7 @@ void Vehicle::UpdateViewport(bool dirty)
 	Rect old_coord = this->sprite_cache.old_coord;
 
 	this->UpdateBoundingBoxCoordinates(true);
-	UpdateVehicleViewportHash(this, this->coord.left, this->coord.top, old_coord.left, old_coord.top);
+	UpdateVehicleViewportHash(this, this->coord.left, this->coord.top);
 
 	if (dirty) {
 		if (old_coord.left == INVALID_COORD) {
@@ -44,7 +44,6 @@ BaseVehicleListWindow::GroupBy _grouping[VLT_END][VEH_COMPANY_END];
 Sorting _sorting[BaseVehicleListWindow::GB_END];
 
 static BaseVehicleListWindow::VehicleIndividualSortFunction VehicleNumberSorter;
-static BaseVehicleListWindow::VehicleIndividualSortFunction VehicleNameSorter;
 static BaseVehicleListWindow::VehicleIndividualSortFunction VehicleAgeSorter;
 static BaseVehicleListWindow::VehicleIndividualSortFunction VehicleProfitThisYearSorter;
 static BaseVehicleListWindow::VehicleIndividualSortFunction VehicleProfitLastYearSorter;
@@ -52,15 +51,20 @@ static BaseVehicleListWindow::VehicleIndividualSortFunction VehicleCargoSorter;
 static BaseVehicleListWindow::VehicleIndividualSortFunction VehicleReliabilitySorter;
 static BaseVehicleListWindow::VehicleIndividualSortFunction VehicleMaxSpeedSorter;
 static BaseVehicleListWindow::VehicleIndividualSortFunction VehicleModelSorter;
-static BaseVehicleListWindow::VehicleIndividualSortFunction VehicleValueSorter;
 static BaseVehicleListWindow::VehicleIndividualSortFunction VehicleLengthSorter;
 static BaseVehicleListWindow::VehicleIndividualSortFunction VehicleTimeToLiveSorter;
 static BaseVehicleListWindow::VehicleIndividualSortFunction VehicleTimetableDelaySorter;
+static BaseVehicleListWindow::VehicleGroupSortFunction VehicleNameSorter;
+static BaseVehicleListWindow::VehicleGroupSortFunction VehicleValueSorter;
 static BaseVehicleListWindow::VehicleGroupSortFunction VehicleGroupLengthSorter;
 static BaseVehicleListWindow::VehicleGroupSortFunction VehicleGroupTotalProfitThisYearSorter;
 static BaseVehicleListWindow::VehicleGroupSortFunction VehicleGroupTotalProfitLastYearSorter;
 static BaseVehicleListWindow::VehicleGroupSortFunction VehicleGroupAverageProfitThisYearSorter;
 static BaseVehicleListWindow::VehicleGroupSortFunction VehicleGroupAverageProfitLastYearSorter;
+static BaseVehicleListWindow::VehicleGroupSortKeyFunction VehicleNameSortKey;
+static BaseVehicleListWindow::VehicleGroupSortKeyFunction VehicleValueSortKey;
+static BaseVehicleListWindow::VehicleGroupSortKeyFunction VehicleGroupProfitThisYearSortKey;
+static BaseVehicleListWindow::VehicleGroupSortKeyFunction VehicleGroupProfitLastYearSortKey;
 
 /** Wrapper to convert a VehicleIndividualSortFunction to a VehicleGroupSortFunction */
 template <BaseVehicleListWindow::VehicleIndividualSortFunction func>
@@ -71,7 +75,7 @@ static bool VehicleIndividualToGroupSorterWrapper(GUIVehicleGroup const &a, GUIV
 
 BaseVehicleListWindow::VehicleGroupSortFunction * const BaseVehicleListWindow::vehicle_group_none_sorter_funcs[] = {
 	&VehicleIndividualToGroupSorterWrapper<VehicleNumberSorter>,
-	&VehicleIndividualToGroupSorterWrapper<VehicleNameSorter>,
+	&VehicleNameSorter,
 	&VehicleIndividualToGroupSorterWrapper<VehicleAgeSorter>,
 	&VehicleIndividualToGroupSorterWrapper<VehicleProfitThisYearSorter>,
 	&VehicleIndividualToGroupSorterWrapper<VehicleProfitLastYearSorter>,
@@ -79,12 +83,30 @@ BaseVehicleListWindow::VehicleGroupSortFunction * const BaseVehicleListWindow::v
 	&VehicleIndividualToGroupSorterWrapper<VehicleReliabilitySorter>,
 	&VehicleIndividualToGroupSorterWrapper<VehicleMaxSpeedSorter>,
 	&VehicleIndividualToGroupSorterWrapper<VehicleModelSorter>,
-	&VehicleIndividualToGroupSorterWrapper<VehicleValueSorter>,
+	&VehicleValueSorter,
 	&VehicleIndividualToGroupSorterWrapper<VehicleLengthSorter>,
 	&VehicleIndividualToGroupSorterWrapper<VehicleTimeToLiveSorter>,
 	&VehicleIndividualToGroupSorterWrapper<VehicleTimetableDelaySorter>,
 };
 
+/** Functions computing the sort keys for vehicle_group_none_sorter_funcs, if the sorter needs them. */
+BaseVehicleListWindow::VehicleGroupSortKeyFunction * const BaseVehicleListWindow::vehicle_group_none_sort_key_funcs[] = {
+	nullptr,
+	&VehicleNameSortKey,
+	nullptr,
+	nullptr,
+	nullptr,
+	nullptr,
+	nullptr,
+	nullptr,
+	nullptr,
+	&VehicleValueSortKey,
+	nullptr,
+	nullptr,
+	nullptr,
+};
+static_assert(lengthof(BaseVehicleListWindow::vehicle_group_none_sort_key_funcs) == lengthof(BaseVehicleListWindow::vehicle_group_none_sorter_funcs));
+
 const StringID BaseVehicleListWindow::vehicle_group_none_sorter_names[] = {
 	STR_SORT_BY_NUMBER,
 	STR_SORT_BY_NAME,
@@ -110,6 +132,16 @@ BaseVehicleListWindow::VehicleGroupSortFunction * const BaseVehicleListWindow::v
 	&VehicleGroupAverageProfitLastYearSorter,
 };
 
+/** Functions computing the sort keys for vehicle_group_shared_orders_sorter_funcs, if the sorter needs them. */
+BaseVehicleListWindow::VehicleGroupSortKeyFunction * const BaseVehicleListWindow::vehicle_group_shared_orders_sort_key_funcs[] = {
+	nullptr,
+	&VehicleGroupProfitThisYearSortKey,
+	&VehicleGroupProfitLastYearSortKey,
+	&VehicleGroupProfitThisYearSortKey,
+	&VehicleGroupProfitLastYearSortKey,
+};
+static_assert(lengthof(BaseVehicleListWindow::vehicle_group_shared_orders_sort_key_funcs) == lengthof(BaseVehicleListWindow::vehicle_group_shared_orders_sorter_funcs));
+
 const StringID BaseVehicleListWindow::vehicle_group_shared_orders_sorter_names[] = {
 	STR_SORT_BY_NUM_VEHICLES,
 	STR_SORT_BY_TOTAL_PROFIT_THIS_YEAR,
@@ -262,15 +294,17 @@ DropDownList BaseVehicleListWindow::BuildActionDropdownList(bool show_autoreplac
 	return list;
 }
 
-/* cached values for VehicleNameSorter to spare many GetString() calls */
-static const Vehicle *_last_vehicle[2] = { nullptr, nullptr };
-
 void BaseVehicleListWindow::SortVehicleList()
 {
-	if (this->vehgroups.Sort()) return;
+	if (!this->vehgroups.IsResortPending()) return;
+
+	/* Compute expensive sort criteria once for every group instead of for every comparison. */
+	VehicleGroupSortKeyFunction *sort_key = this->GetVehicleSortKeyFuncs()[this->vehgroups.SortType()];
+	if (sort_key != nullptr) {
+		for (GUIVehicleGroup &vehgroup : this->vehgroups) sort_key(vehgroup);
+	}
 
-	/* invalidate cached values for name sorter - vehicle names could change */
-	_last_vehicle[0] = _last_vehicle[1] = nullptr;
+	this->vehgroups.Sort();
 }
 
 void DepotSortList(VehicleList *list)
@@ -1170,28 +1204,40 @@ static bool VehicleGroupLengthSorter(const GUIVehicleGroup &a, const GUIVehicleG
 	return a.NumVehicles() < b.NumVehicles();
 }
 
+/** Compute the total profit this year of a vehicle group, for sorting by it. */
+static void VehicleGroupProfitThisYearSortKey(GUIVehicleGroup &vehgroup)
+{
+	vehgroup.sort_value = vehgroup.GetDisplayProfitThisYear();
+}
+
+/** Compute the total profit last year of a vehicle group, for sorting by it. */
+static void VehicleGroupProfitLastYearSortKey(GUIVehicleGroup &vehgroup)
+{
+	vehgroup.sort_value = vehgroup.GetDisplayProfitLastYear();
+}
+
 /** Sort vehicle groups by the total profit this year */
 static bool VehicleGroupTotalProfitThisYearSorter(const GUIVehicleGroup &a, const GUIVehicleGroup &b)
 {
-	return a.GetDisplayProfitThisYear() < b.GetDisplayProfitThisYear();
+	return a.sort_value < b.sort_value;
 }
 
 /** Sort vehicle groups by the total profit last year */
 static bool VehicleGroupTotalProfitLastYearSorter(const GUIVehicleGroup &a, const GUIVehicleGroup &b)
 {
-	return a.GetDisplayProfitLastYear() < b.GetDisplayProfitLastYear();
+	return a.sort_value < b.sort_value;
 }
 
 /** Sort vehicle groups by the average profit this year */
 static bool VehicleGroupAverageProfitThisYearSorter(const GUIVehicleGroup &a, const GUIVehicleGroup &b)
 {
-	return a.GetDisplayProfitThisYear() * static_cast<uint>(b.NumVehicles()) < b.GetDisplayProfitThisYear() * static_cast<uint>(a.NumVehicles());
+	return a.sort_value * static_cast<uint>(b.NumVehicles()) < b.sort_value * static_cast<uint>(a.NumVehicles());
 }
 
 /** Sort vehicle groups by the average profit last year */
 static bool VehicleGroupAverageProfitLastYearSorter(const GUIVehicleGroup &a, const GUIVehicleGroup &b)
 {
-	return a.GetDisplayProfitLastYear() * static_cast<uint>(b.NumVehicles()) < b.GetDisplayProfitLastYear() * static_cast<uint>(a.NumVehicles());
+	return a.sort_value * static_cast<uint>(b.NumVehicles()) < b.sort_value * static_cast<uint>(a.NumVehicles());
 }
 
 /** Sort vehicles by their number */
@@ -1200,25 +1246,21 @@ static bool VehicleNumberSorter(const Vehicle * const &a, const Vehicle * const
 	return a->unitnumber < b->unitnumber;
 }
 
-/** Sort vehicles by their name */
-static bool VehicleNameSorter(const Vehicle * const &a, const Vehicle * const &b)
+/** Compute the name of a vehicle, for sorting by it. */
+static void VehicleNameSortKey(GUIVehicleGroup &vehgroup)
 {
-	static char last_name[2][64];
-
-	if (a != _last_vehicle[0]) {
-		_last_vehicle[0] = a;
-		SetDParam(0, a->index);
-		GetString(last_name[0], STR_VEHICLE_NAME, lastof(last_name[0]));
-	}
+	char buf[64];
 
-	if (b != _last_vehicle[1]) {
-		_last_vehicle[1] = b;
-		SetDParam(0, b->index);
-		GetString(last_name[1], STR_VEHICLE_NAME, lastof(last_name[1]));
-	}
+	SetDParam(0, (*vehgroup.vehicles_begin)->index);
+	GetString(buf, STR_VEHICLE_NAME, lastof(buf));
+	vehgroup.sort_name = buf;
+}
 
-	int r = strnatcmp(last_name[0], last_name[1]); // Sort by name (natural sorting).
-	return (r != 0) ? r < 0: VehicleNumberSorter(a, b);
+/** Sort vehicles by their name */
+static bool VehicleNameSorter(const GUIVehicleGroup &a, const GUIVehicleGroup &b)
+{
+	int r = strnatcmp(a.sort_name.c_str(), b.sort_name.c_str()); // Sort by name (natural sorting).
+	return (r != 0) ? r < 0: VehicleNumberSorter(*a.vehicles_begin, *b.vehicles_begin);
 }
 
 /** Sort vehicles by their age */
@@ -1282,17 +1324,19 @@ static bool VehicleModelSorter(const Vehicle * const &a, const Vehicle * const &
 	return (r != 0) ? r < 0 : VehicleNumberSorter(a, b);
 }
 
-/** Sort vehicles by their value */
-static bool VehicleValueSorter(const Vehicle * const &a, const Vehicle * const &b)
+/** Compute the value of a vehicle, for sorting by it. */
+static void VehicleValueSortKey(GUIVehicleGroup &vehgroup)
 {
-	const Vehicle *u;
-	Money diff = 0;
-
-	for (u = a; u != nullptr; u = u->Next()) diff += u->value;
-	for (u = b; u != nullptr; u = u->Next()) diff -= u->value;
+	Money value = 0;
+	for (const Vehicle *u = *vehgroup.vehicles_begin; u != nullptr; u = u->Next()) value += u->value;
+	vehgroup.sort_value = value;
+}
 
-	int r = ClampToI32(diff);
-	return (r != 0) ? r < 0 : VehicleNumberSorter(a, b);
+/** Sort vehicles by their value */
+static bool VehicleValueSorter(const GUIVehicleGroup &a, const GUIVehicleGroup &b)
+{
+	int r = ClampToI32(a.sort_value - b.sort_value);
+	return (r != 0) ? r < 0 : VehicleNumberSorter(*a.vehicles_begin, *b.vehicles_begin);
 }
 
 /** Sort vehicles by their length */
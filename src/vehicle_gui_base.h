@@ -21,6 +21,7 @@
 
 #include <iterator>
 #include <numeric>
+#include <string>
 
 typedef GUIList<const Vehicle*> GUIVehicleList;
 
@@ -28,8 +29,11 @@ struct GUIVehicleGroup {
 	VehicleList::const_iterator vehicles_begin;    ///< Pointer to beginning element of this vehicle group.
 	VehicleList::const_iterator vehicles_end;      ///< Pointer to past-the-end element of this vehicle group.
 
+	Money sort_value;                              ///< Sort criterion computed once per resort, for criteria that are expensive to compute.
+	std::string sort_name;                         ///< Name computed once per resort, when sorting by name.
+
 	GUIVehicleGroup(VehicleList::const_iterator vehicles_begin, VehicleList::const_iterator vehicles_end)
-		: vehicles_begin(vehicles_begin), vehicles_end(vehicles_end) {}
+		: vehicles_begin(vehicles_begin), vehicles_end(vehicles_end), sort_value(0) {}
 
 	std::ptrdiff_t NumVehicles() const
 	{
@@ -86,6 +90,7 @@ struct BaseVehicleListWindow : public Window {
 
 	typedef GUIVehicleGroupList::SortFunction VehicleGroupSortFunction;
 	typedef GUIVehicleList::SortFunction VehicleIndividualSortFunction;
+	typedef void VehicleGroupSortKeyFunction(GUIVehicleGroup &); ///< Signature of the function computing the sort key of a group before resorting.
 
 	enum ActionDropdownItem {
 		ADI_REPLACE,
@@ -101,6 +106,8 @@ struct BaseVehicleListWindow : public Window {
 	static const StringID vehicle_group_shared_orders_sorter_names[];
 	static VehicleGroupSortFunction * const vehicle_group_none_sorter_funcs[];
 	static VehicleGroupSortFunction * const vehicle_group_shared_orders_sorter_funcs[];
+	static VehicleGroupSortKeyFunction * const vehicle_group_none_sort_key_funcs[];
+	static VehicleGroupSortKeyFunction * const vehicle_group_shared_orders_sort_key_funcs[];
 
 	BaseVehicleListWindow(WindowDesc *desc, WindowNumber wno);
 
@@ -136,6 +143,18 @@ struct BaseVehicleListWindow : public Window {
 				NOT_REACHED();
 		}
 	}
+
+	VehicleGroupSortKeyFunction * const *GetVehicleSortKeyFuncs()
+	{
+		switch (this->grouping) {
+			case GB_NONE:
+				return vehicle_group_none_sort_key_funcs;
+			case GB_SHARED_ORDERS:
+				return vehicle_group_shared_orders_sort_key_funcs;
+			default:
+				NOT_REACHED();
+		}
+	}
 };
 
 uint GetVehicleListHeight(VehicleType type, uint divisor = 1);
@@ -11,6 +11,7 @@
 #include "train.h"
 #include "vehiclelist.h"
 #include "group.h"
+#include "company_base.h"
 
 #include "safeguards.h"
 
@@ -105,6 +106,23 @@ void BuildDepotVehicleList(VehicleType type, TileIndex tile, VehicleList *engine
 	if (wagons != nullptr && wagons != engines) wagons->shrink_to_fit();
 }
 
+/**
+ * Add the primary vehicles of a group and its sub-groups to a list.
+ * @param list    Pointer to list to add vehicles to
+ * @param company The company the group belongs to
+ * @param id_g    The group to add the vehicles of
+ * @param type    The vehicle type of the group
+ */
+static void AddGroupVehicles(VehicleList *list, CompanyID company, GroupID id_g, VehicleType type)
+{
+	for (const Group *g : Group::Iterate()) {
+		if (g->parent == id_g) AddGroupVehicles(list, company, g->index, type);
+	}
+
+	const VehicleList &vehicles = GroupStatistics::Get(company, id_g, type).vehicles;
+	list->insert(list->end(), vehicles.begin(), vehicles.end());
+}
+
 /**
  * Generate a list of vehicles based on window type.
  * @param list Pointer to list to add vehicles to
@@ -142,24 +160,26 @@ bool GenerateVehicleSortList(VehicleList *list, const VehicleListIdentifier &vli
 		}
 
 		case VL_GROUP_LIST:
-			if (vli.index != ALL_GROUP) {
-				for (const Vehicle *v : Vehicle::Iterate()) {
-					if (v->type == vli.vtype && v->IsPrimaryVehicle() &&
-							v->owner == vli.company && GroupIsInGroup(v->group_id, vli.index)) {
-						list->push_back(v);
-					}
-				}
-				break;
+		case VL_STANDARD: {
+			/* The groups keep track of their primary vehicles, so there is no need to look at all vehicles. */
+			if (!Company::IsValidID(vli.company) || vli.vtype >= VEH_COMPANY_END) break;
+
+			GroupID id_g = vli.type == VL_STANDARD ? ALL_GROUP : vli.index;
+			if (IsAllGroupID(id_g)) {
+				const VehicleList &vehicles = GroupStatistics::Get(vli.company, ALL_GROUP, vli.vtype).vehicles;
+				list->assign(vehicles.begin(), vehicles.end());
+			} else if (IsDefaultGroupID(id_g)) {
+				AddGroupVehicles(list, vli.company, id_g, vli.vtype);
+			} else {
+				const Group *g = Group::GetIfValid(id_g);
+				if (g == nullptr || g->owner != vli.company || g->vehicle_type != vli.vtype) break;
+				AddGroupVehicles(list, vli.company, id_g, vli.vtype);
 			}
-			FALLTHROUGH;
 
-		case VL_STANDARD:
-			for (const Vehicle *v : Vehicle::Iterate()) {
-				if (v->type == vli.vtype && v->owner == vli.company && v->IsPrimaryVehicle()) {
-					list->push_back(v);
-				}
-			}
+			/* Commands act on the vehicles in list order, so keep the order of the vehicle pool. */
+			std::sort(list->begin(), list->end(), [](const Vehicle *a, const Vehicle *b) { return a->index < b->index; });
 			break;
+		}
 
 		case VL_DEPOT_LIST:
 			for (const Vehicle *v : Vehicle::Iterate()) {
@@ -88,10 +88,9 @@
 #include "command_func.h"
 #include "network/network_func.h"
 #include "framerate_type.h"
+#include "smallmap_gui.h"
 
-#include <forward_list>
 #include <map>
-#include <stack>
 
 #include "table/strings.h"
 #include "table/string_colours.h"
@@ -1161,6 +1160,9 @@ static int GetViewportY(Point tile)
 
 /**
  * Add the landscape to the viewport, i.e. all ground tiles and buildings.
+ * The sprites of each tile are generated again on every draw. Their draw procs also read
+ * neighbouring tiles, NewGRF state, transparency options and the zoom level, so a cache
+ * keyed on changes of the tile itself would show stale graphics.
  */
 static void ViewportAddLandscape()
 {
@@ -1196,10 +1198,8 @@ static void ViewportAddLandscape()
 	bool last_row = false;
 	for (; !last_row; row++) {
 		last_row = true;
-		for (int column = left_column; column <= right_column; column++) {
-			/* Valid row/column? */
-			if ((row + column) % 2 != 0) continue;
-
+		/* Only visit valid row/column pairs, i.e. those that are both even or both odd. */
+		for (int column = left_column + ((row + left_column) & 1); column <= right_column; column += 2) {
 			Point tilecoord;
 			tilecoord.x = (row - column) / 2;
 			tilecoord.y = (row + column) / 2;
@@ -1513,28 +1513,40 @@ static void ViewportSortParentSprites(ParentSpriteToSortVector *psdv)
 	 */
 	const uint32 ORDER_COMPARED = UINT32_MAX; // Sprite was compared but we still need to compare the ones preceding it
 	const uint32 ORDER_RETURNED = UINT32_MAX - 1; // Makr sorted sprite in case there are other occurrences of it in the stack
-	std::stack<ParentSpriteToDraw *> sprite_order;
 	uint32 next_order = 0;
 
-	std::forward_list<std::pair<int64, ParentSpriteToDraw *>> sprite_list;  // We store sprites in a list sorted by xmin+ymin
+	/* The buffers are kept between calls, so sorting every frame does not need to allocate memory. */
+	static std::vector<ParentSpriteToDraw *> sprite_order; // Stack of sprites to output
+	static std::vector<std::pair<int64, ParentSpriteToDraw *>> sprite_list; // We store sprites in a list sorted by xmin+ymin
+	static std::vector<uint> sprite_next; // Index of the next sprite in sprite_list that has not been removed from it
+	static std::vector<ParentSpriteToDraw *> preceding; // Temporarily stores sprites that precede current and their position in the list
 
 	/* Initialize sprite list and order. */
+	sprite_order.clear();
+	sprite_list.clear();
 	for (auto p = psdv->rbegin(); p != psdv->rend(); p++) {
-		sprite_list.push_front(std::make_pair((*p)->xmin + (*p)->ymin, *p));
-		sprite_order.push(*p);
+		sprite_list.emplace_back((*p)->xmin + (*p)->ymin, *p);
+		sprite_order.push_back(*p);
 		(*p)->order = next_order++;
 	}
 
-	sprite_list.sort();
+	std::sort(sprite_list.begin(), sprite_list.end());
+
+	/* Link the sorted sprites; list_head is the position before the first sprite. */
+	const uint list_head = (uint)sprite_list.size();
+	const uint list_end = list_head + 1;
+	sprite_next.resize(list_head + 1);
+	for (uint i = 0; i < list_head; i++) sprite_next[i] = i + 1;
+	sprite_next[list_head - 1] = list_end;
+	sprite_next[list_head] = 0;
 
-	std::vector<ParentSpriteToDraw *> preceding;  // Temporarily stores sprites that precede current and their position in the list
-	auto preceding_prev = sprite_list.begin(); // Store iterator in case we need to delete a single preciding sprite
+	uint preceding_prev = list_head; // Store position in case we need to delete a single preciding sprite
 	auto out = psdv->begin();  // Iterator to output sorted sprites
 
 	while (!sprite_order.empty()) {
 
-		auto s = sprite_order.top();
-		sprite_order.pop();
+		auto s = sprite_order.back();
+		sprite_order.pop_back();
 
 		/* Sprite is already sorted, ignore it. */
 		if (s->order == ORDER_RETURNED) continue;
@@ -1557,18 +1569,19 @@ static void ViewportSortParentSprites(ParentSpriteToSortVector *psdv)
 		 * to ensure that we iterate the current sprite as we need to remove it from the list.
 		 */
 		auto ssum = std::max(s->xmax, s->xmin) + std::max(s->ymax, s->ymin);
-		auto prev = sprite_list.before_begin();
-		auto x = sprite_list.begin();
-		while (x != sprite_list.end() && ((*x).first <= ssum)) {
-			auto p = (*x).second;
+		uint prev = list_head;
+		uint x = sprite_next[prev];
+		while (x != list_end && sprite_list[x].first <= ssum) {
+			auto p = sprite_list[x].second;
 			if (p == s) {
 				/* We found the current sprite, remove it and move on. */
-				x = sprite_list.erase_after(prev);
+				x = sprite_next[prev] = sprite_next[x];
 				continue;
 			}
 
-			auto p_prev = prev;
-			prev = x++;
+			uint p_prev = prev;
+			prev = x;
+			x = sprite_next[x];
 
 			if (s->xmax < p->xmin || s->ymax < p->ymin || s->zmax < p->zmin) continue;
 			if (s->xmin <= p->xmax && // overlap in X?
@@ -1597,7 +1610,7 @@ static void ViewportSortParentSprites(ParentSpriteToSortVector *psdv)
 			if (p->xmax <= s->xmax && p->ymax <= s->ymax && p->zmax <= s->zmax) {
 				p->order = ORDER_RETURNED;
 				s->order = ORDER_RETURNED;
-				sprite_list.erase_after(preceding_prev);
+				sprite_next[preceding_prev] = sprite_next[sprite_next[preceding_prev]];
 				*(out++) = p;
 				*(out++) = s;
 				continue;
@@ -1610,11 +1623,11 @@ static void ViewportSortParentSprites(ParentSpriteToSortVector *psdv)
 		});
 
 		s->order = ORDER_COMPARED;
-		sprite_order.push(s);  // Still need to output so push it back for now
+		sprite_order.push_back(s);  // Still need to output so push it back for now
 
 		for (auto p: preceding) {
 			p->order = next_order++;
-			sprite_order.push(p);
+			sprite_order.push_back(p);
 		}
 	}
 }
@@ -1711,6 +1724,158 @@ static void ViewportDrawStrings(ZoomLevel zoom, const StringSpriteToDrawVector *
 	}
 }
 
+static std::vector<uint8> _viewport_lod_colours;     ///< Colours of the tiles in viewports that show a simplified map, see #GetSmallMapLodColour.
+static std::vector<bool> _viewport_lod_colour_valid; ///< Whether the colour of a tile in #_viewport_lod_colours is up to date.
+
+/**
+ * Forget the colours of the tiles in viewports that show a simplified map.
+ */
+void ResetViewportLodColours()
+{
+	_viewport_lod_colours.clear();
+	_viewport_lod_colour_valid.clear();
+}
+
+/**
+ * Check whether a viewport is zoomed out so far that it shows a simplified map.
+ * @param zoom The zoom level of the viewport.
+ * @return True if tiles are drawn as blocks of colour and vehicles as dots.
+ */
+static inline bool IsViewportLodZoom(ZoomLevel zoom)
+{
+	return zoom >= _settings_client.gui.viewport_lod_zoom;
+}
+
+/**
+ * Get the colour to outline a tile with in the simplified map, following
+ * what #DrawTileSelection highlights on the normal map.
+ * @param tile The tile.
+ * @return The colour of the outline, or 0 when the tile is not highlighted.
+ */
+static uint8 GetLodSelectionColour(TileIndex tile)
+{
+	if (_thd.redsq == tile) return PC_RED;
+
+	int x = TileX(tile) * TILE_SIZE;
+	int y = TileY(tile) * TILE_SIZE;
+	if ((_thd.drawstyle & HT_DRAG_MASK) != HT_NONE) {
+		bool inner = _thd.diagonal ? IsInsideRotatedRectangle(x, y) : (IsInsideBS(x, _thd.pos.x, _thd.size.x) && IsInsideBS(y, _thd.pos.y, _thd.size.y));
+		if (inner && ((_thd.drawstyle & (HT_RECT | HT_POINT | HT_RAIL)) != 0 || IsPartOfAutoLine(x, y))) {
+			return _thd.make_square_red ? PC_RED : PC_WHITE;
+		}
+	}
+
+	TileHighlightType tht = GetTileHighlightType(tile);
+	switch (tht) {
+		case THT_WHITE: return PC_WHITE;
+		case THT_BLUE:  return PC_LIGHT_BLUE;
+		default: break;
+	}
+
+	if (_thd.outersize.x > 0 && (_thd.drawstyle & HT_DRAG_MASK) != HT_NONE &&
+			IsInsideBS(x, _thd.pos.x + _thd.offs.x, _thd.size.x + _thd.outersize.x) &&
+			IsInsideBS(y, _thd.pos.y + _thd.offs.y, _thd.size.y + _thd.outersize.y)) {
+		return PC_LIGHT_BLUE;
+	}
+
+	return tht == THT_RED ? PC_RED : 0;
+}
+
+/**
+ * Draw the landscape and the vehicles of the area in #_vd as a simplified map.
+ * Every tile is a block in its smallmap colour at its height and every vehicle is a dot.
+ * The rows of tiles are drawn from north to south, so nearer tiles cover the tiles behind them.
+ */
+static void ViewportDrawLandscapeLod()
+{
+	ZoomLevel zoom = _vd.dpi.zoom;
+
+	DrawPixelInfo dp = _vd.dpi;
+	dp.zoom = ZOOM_LVL_NORMAL;
+	dp.left = UnScaleByZoom(_vd.dpi.left, zoom);
+	dp.top = UnScaleByZoom(_vd.dpi.top, zoom);
+	dp.width = UnScaleByZoom(_vd.dpi.width, zoom);
+	dp.height = UnScaleByZoom(_vd.dpi.height, zoom);
+	DrawPixelInfo *old_dpi = _cur_dpi;
+	_cur_dpi = &dp;
+
+	/* Outside of the map everything is black. */
+	GfxFillRect(dp.left, dp.top, dp.left + dp.width - 1, dp.top + dp.height - 1, PC_BLACK);
+
+	if (_viewport_lod_colours.size() != MapSize()) {
+		_viewport_lod_colours.assign(MapSize(), 0);
+		_viewport_lod_colour_valid.assign(MapSize(), false);
+	}
+
+	/* See ViewportAddLandscape for the transformation between tile coordinates and viewport rows/columns. */
+	Point upper_left = InverseRemapCoords(_vd.dpi.left, _vd.dpi.top);
+	Point upper_right = InverseRemapCoords(_vd.dpi.left + _vd.dpi.width, _vd.dpi.top);
+	Point lower_left = InverseRemapCoords(_vd.dpi.left, _vd.dpi.top + _vd.dpi.height);
+
+	int left_column = std::max((upper_left.y - upper_left.x) / (int)TILE_SIZE - 2, -(int)MapMaxX());
+	int right_column = std::min((upper_right.y - upper_right.x) / (int)TILE_SIZE + 2, (int)MapMaxY());
+	int first_row = std::max((upper_left.x + upper_left.y) / (int)TILE_SIZE - 2, 0);
+	/* High tiles are drawn further up, so rows below the area can still be visible. */
+	int last_row = std::min((lower_left.x + lower_left.y + _settings_game.construction.map_height_limit * (int)TILE_HEIGHT) / (int)TILE_SIZE + 2, (int)(MapMaxX() + MapMaxY()));
+
+	/* Highlighted tiles are outlined after all blocks are drawn, so nearer blocks do not cover the outlines. */
+	static std::vector<std::pair<Rect, uint8>> selection;
+	selection.clear();
+
+	for (int row = first_row; row <= last_row; row++) {
+		/* Neighbouring tiles of the same colour and height are drawn as one block. */
+		Rect run = {0, 0, -1, 0};
+		uint8 run_colour = 0;
+
+		for (int column = left_column + ((row + left_column) & 1); column <= right_column; column += 2) {
+			int x = (row - column) / 2;
+			int y = (row + column) / 2;
+			if (!IsInsideBS(x, 0, MapSizeX()) || !IsInsideBS(y, 0, MapSizeY())) continue;
+
+			TileIndex tile = TileXY(x, y);
+			if (!_viewport_lod_colour_valid[tile]) {
+				_viewport_lod_colours[tile] = GetSmallMapLodColour(tile);
+				_viewport_lod_colour_valid[tile] = true;
+			}
+			uint8 colour = _viewport_lod_colours[tile];
+
+			/* The block of a tile covers its middle and its southern half, which the blocks of nearer tiles partly cover again. */
+			Point pt = RemapCoords(x * TILE_SIZE, y * TILE_SIZE, TilePixelHeight(tile));
+			Rect block;
+			block.left = UnScaleByZoomLower(pt.x - MAX_TILE_EXTENT_LEFT, zoom);
+			block.right = UnScaleByZoomLower(pt.x + MAX_TILE_EXTENT_RIGHT, zoom) - 1;
+			block.top = UnScaleByZoomLower(pt.y + ZOOM_LVL_BASE * TILE_PIXELS / 4, zoom);
+			block.bottom = UnScaleByZoomLower(pt.y + ZOOM_LVL_BASE * TILE_PIXELS, zoom) - 1;
+
+			uint8 selection_colour = GetLodSelectionColour(tile);
+			if (selection_colour != 0) selection.emplace_back(block, selection_colour);
+
+			if (run.right >= run.left && colour == run_colour && block.top == run.top && block.left == run.right + 1) {
+				run.right = block.right;
+				continue;
+			}
+
+			if (run.right >= run.left) GfxFillRect(run.left, run.top, run.right, run.bottom, run_colour);
+			run = block;
+			run_colour = colour;
+		}
+
+		if (run.right >= run.left) GfxFillRect(run.left, run.top, run.right, run.bottom, run_colour);
+	}
+
+	for (const auto &sel : selection) {
+		const Rect &r = sel.first;
+		GfxFillRect(r.left, r.top, r.right, r.top, sel.second);
+		GfxFillRect(r.left, r.bottom, r.right, r.bottom, sel.second);
+		GfxFillRect(r.left, r.top, r.left, r.bottom, sel.second);
+		GfxFillRect(r.right, r.top, r.right, r.bottom, sel.second);
+	}
+
+	ViewportDrawVehicleMarkers(&_vd.dpi);
+
+	_cur_dpi = old_dpi;
+}
+
 void ViewportDoDraw(const Viewport *vp, int left, int top, int right, int bottom)
 {
 	DrawPixelInfo *old_dpi = _cur_dpi;
@@ -1733,8 +1898,12 @@ void ViewportDoDraw(const Viewport *vp, int left, int top, int right, int bottom
 
 	_vd.dpi.dst_ptr = BlitterFactory::GetCurrentBlitter()->MoveTo(old_dpi->dst_ptr, x - old_dpi->left, y - old_dpi->top);
 
-	ViewportAddLandscape();
-	ViewportAddVehicles(&_vd.dpi);
+	if (IsViewportLodZoom(vp->zoom)) {
+		ViewportDrawLandscapeLod();
+	} else {
+		ViewportAddLandscape();
+		ViewportAddVehicles(&_vd.dpi);
+	}
 
 	ViewportAddKdtreeSigns(&_vd.dpi);
 
@@ -1782,6 +1951,42 @@ void ViewportDoDraw(const Viewport *vp, int left, int top, int right, int bottom
 	_vd.child_screen_sprites_to_draw.clear();
 }
 
+/** Largest area of the virtual screen that is drawn at once; larger areas are split. */
+static const int64 MAX_VIEWPORT_DRAW_AREA = 180000 * ZOOM_LVL_BASE * ZOOM_LVL_BASE;
+
+/**
+ * Make sure we don't draw a too big area at a time.
+ * The time needed to sort the parent sprites grows quadratically with their number,
+ * so big areas are split into smaller parts that each have fewer sprites. The parts
+ * are drawn one after another, as they all use the global #ViewportDrawer.
+ * @param vp The viewport to draw.
+ * @param left Left edge of the area, in screen coordinates.
+ * @param top Top edge of the area, in screen coordinates.
+ * @param right Right edge of the area, in screen coordinates.
+ * @param bottom Bottom edge of the area, in screen coordinates.
+ */
+static void ViewportDrawChk(const Viewport *vp, int left, int top, int right, int bottom)
+{
+	if ((int64)ScaleByZoom(bottom - top, vp->zoom) * ScaleByZoom(right - left, vp->zoom) > MAX_VIEWPORT_DRAW_AREA) {
+		if ((bottom - top) > (right - left)) {
+			int t = (top + bottom) >> 1;
+			ViewportDrawChk(vp, left, top, right, t);
+			ViewportDrawChk(vp, left, t, right, bottom);
+		} else {
+			int t = (left + right) >> 1;
+			ViewportDrawChk(vp, left, top, t, bottom);
+			ViewportDrawChk(vp, t, top, right, bottom);
+		}
+	} else {
+		ViewportDoDraw(vp,
+			ScaleByZoom(left - vp->left, vp->zoom) + vp->virtual_left,
+			ScaleByZoom(top - vp->top, vp->zoom) + vp->virtual_top,
+			ScaleByZoom(right - vp->left, vp->zoom) + vp->virtual_left,
+			ScaleByZoom(bottom - vp->top, vp->zoom) + vp->virtual_top
+		);
+	}
+}
+
 static inline void ViewportDraw(const Viewport *vp, int left, int top, int right, int bottom)
 {
 	if (right <= vp->left || bottom <= vp->top) return;
@@ -1796,12 +2001,7 @@ static inline void ViewportDraw(const Viewport *vp, int left, int top, int right
 	if (top < vp->top) top = vp->top;
 	if (bottom > vp->top + vp->height) bottom = vp->top + vp->height;
 
-	ViewportDoDraw(vp,
-		ScaleByZoom(left - vp->left, vp->zoom) + vp->virtual_left,
-		ScaleByZoom(top - vp->top, vp->zoom) + vp->virtual_top,
-		ScaleByZoom(right - vp->left, vp->zoom) + vp->virtual_left,
-		ScaleByZoom(bottom - vp->top, vp->zoom) + vp->virtual_top
-	);
+	ViewportDrawChk(vp, left, top, right, bottom);
 }
 
 /**
@@ -1984,6 +2184,9 @@ void ConstrainAllViewportsZoom()
  */
 void MarkTileDirtyByTile(TileIndex tile, int bridge_level_offset, int tile_height_override)
 {
+	MarkSmallMapTileDirty(tile);
+	if (tile < _viewport_lod_colour_valid.size()) _viewport_lod_colour_valid[tile] = false;
+
 	Point pt = RemapCoords(TileX(tile) * TILE_SIZE, TileY(tile) * TILE_SIZE, tile_height_override * TILE_HEIGHT);
 	MarkAllViewportsDirty(
 			pt.x - MAX_TILE_EXTENT_LEFT,
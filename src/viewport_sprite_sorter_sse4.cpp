@@ -13,9 +13,7 @@
 #include "cpu.h"
 #include "smmintrin.h"
 #include "viewport_sprite_sorter.h"
-#include <forward_list>
 #include <map>
-#include <stack>
 
 #include "safeguards.h"
 
@@ -41,28 +39,40 @@ void ViewportSortParentSpritesSSE41(ParentSpriteToSortVector *psdv)
 	 */
 	const uint32 ORDER_COMPARED = UINT32_MAX; // Sprite was compared but we still need to compare the ones preceding it
 	const uint32 ORDER_RETURNED = UINT32_MAX - 1; // Mark sorted sprite in case there are other occurrences of it in the stack
-	std::stack<ParentSpriteToDraw *> sprite_order;
 	uint32 next_order = 0;
 
-	std::forward_list<std::pair<int64, ParentSpriteToDraw *>> sprite_list;  // We store sprites in a list sorted by xmin+ymin
+	/* The buffers are kept between calls, so sorting every frame does not need to allocate memory. */
+	static std::vector<ParentSpriteToDraw *> sprite_order; // Stack of sprites to output
+	static std::vector<std::pair<int64, ParentSpriteToDraw *>> sprite_list; // We store sprites in a list sorted by xmin+ymin
+	static std::vector<uint> sprite_next; // Index of the next sprite in sprite_list that has not been removed from it
+	static std::vector<ParentSpriteToDraw *> preceding; // Temporarily stores sprites that precede current and their position in the list
 
 	/* Initialize sprite list and order. */
+	sprite_order.clear();
+	sprite_list.clear();
 	for (auto p = psdv->rbegin(); p != psdv->rend(); p++) {
-		sprite_list.push_front(std::make_pair((*p)->xmin + (*p)->ymin, *p));
-		sprite_order.push(*p);
+		sprite_list.emplace_back((*p)->xmin + (*p)->ymin, *p);
+		sprite_order.push_back(*p);
 		(*p)->order = next_order++;
 	}
 
-	sprite_list.sort();
+	std::sort(sprite_list.begin(), sprite_list.end());
 
-	std::vector<ParentSpriteToDraw *> preceding;  // Temporarily stores sprites that precede current and their position in the list
-	auto preceding_prev = sprite_list.begin(); // Store iterator in case we need to delete a single preciding sprite
+	/* Link the sorted sprites; list_head is the position before the first sprite. */
+	const uint list_head = (uint)sprite_list.size();
+	const uint list_end = list_head + 1;
+	sprite_next.resize(list_head + 1);
+	for (uint i = 0; i < list_head; i++) sprite_next[i] = i + 1;
+	sprite_next[list_head - 1] = list_end;
+	sprite_next[list_head] = 0;
+
+	uint preceding_prev = list_head; // Store position in case we need to delete a single preciding sprite
 	auto out = psdv->begin();  // Iterator to output sorted sprites
 
 	while (!sprite_order.empty()) {
 
-		auto s = sprite_order.top();
-		sprite_order.pop();
+		auto s = sprite_order.back();
+		sprite_order.pop_back();
 
 		/* Sprite is already sorted, ignore it. */
 		if (s->order == ORDER_RETURNED) continue;
@@ -85,18 +95,19 @@ void ViewportSortParentSpritesSSE41(ParentSpriteToSortVector *psdv)
 		 * to ensure that we iterate the current sprite as we need to remove it from the list.
 		 */
 		auto ssum = std::max(s->xmax, s->xmin) + std::max(s->ymax, s->ymin);
-		auto prev = sprite_list.before_begin();
-		auto x = sprite_list.begin();
-		while (x != sprite_list.end() && ((*x).first <= ssum)) {
-			auto p = (*x).second;
+		uint prev = list_head;
+		uint x = sprite_next[prev];
+		while (x != list_end && sprite_list[x].first <= ssum) {
+			auto p = sprite_list[x].second;
 			if (p == s) {
 				/* We found the current sprite, remove it and move on. */
-				x = sprite_list.erase_after(prev);
+				x = sprite_next[prev] = sprite_next[x];
 				continue;
 			}
 
-			auto p_prev = prev;
-			prev = x++;
+			uint p_prev = prev;
+			prev = x;
+			x = sprite_next[x];
 
 			/* Check that p->xmin <= s->xmax && p->ymin <= s->ymax && p->zmin <= s->zmax */
 			__m128i s_max = LOAD_128((__m128i*) &s->xmax);
@@ -142,7 +153,7 @@ void ViewportSortParentSpritesSSE41(ParentSpriteToSortVector *psdv)
 			if (p->xmax <= s->xmax && p->ymax <= s->ymax && p->zmax <= s->zmax) {
 				p->order = ORDER_RETURNED;
 				s->order = ORDER_RETURNED;
-				sprite_list.erase_after(preceding_prev);
+				sprite_next[preceding_prev] = sprite_next[sprite_next[preceding_prev]];
 				*(out++) = p;
 				*(out++) = s;
 				continue;
@@ -155,11 +166,11 @@ void ViewportSortParentSpritesSSE41(ParentSpriteToSortVector *psdv)
 		});
 
 		s->order = ORDER_COMPARED;
-		sprite_order.push(s);  // Still need to output so push it back for now
+		sprite_order.push_back(s);  // Still need to output so push it back for now
 
 		for (auto p: preceding) {
 			p->order = next_order++;
-			sprite_order.push(p);
+			sprite_order.push_back(p);
 		}
 	}
 }
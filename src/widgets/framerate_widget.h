@@ -17,6 +17,12 @@ enum FramerateWindowWidgets {
 	WID_FRW_RATE_DRAWING,
 	WID_FRW_RATE_FACTOR,
 	WID_FRW_INFO_DATA_POINTS,
+	WID_FRW_INFO_SPRITE_CACHE_SIZE,
+	WID_FRW_INFO_SPRITE_CACHE_USE,
+	WID_FRW_INFO_SCREEN_REDRAW,
+	WID_FRW_INFO_LINE_CACHE,
+	WID_FRW_INFO_STRING_CACHE,
+	WID_FRW_INFO_SLOWEST_WINDOW,
 	WID_FRW_TIMES_NAMES,
 	WID_FRW_TIMES_CURRENT,
 	WID_FRW_TIMES_AVERAGE,
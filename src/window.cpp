@@ -58,6 +58,14 @@ Window *_z_front_window = nullptr;
 /** List of windows opened at the screen sorted from the back. */
 Window *_z_back_window  = nullptr;
 
+static const uint NUM_COUNTED_WINDOW_CLASSES = WC_SCREENSHOT + 1; ///< Number of window classes, which are numbered without gaps.
+
+/**
+ * Number of open windows of each window class.
+ * Lets invalidations of window classes without open windows skip the scan of all windows.
+ */
+static uint _window_class_count[NUM_COUNTED_WINDOW_CLASSES];
+
 /** If false, highlight is white, otherwise the by the widget defined colour. */
 bool _window_highlight_colour = false;
 
@@ -945,6 +953,8 @@ static void DrawOverlappedWindow(Window *w, int left, int top, int right, int bo
 	dp->pitch = _screen.pitch;
 	dp->dst_ptr = BlitterFactory::GetCurrentBlitter()->MoveTo(_screen.dst_ptr, left, top);
 	dp->zoom = ZOOM_LVL_NORMAL;
+
+	WindowPaintAccumulator framerate(w);
 	w->OnPaint();
 }
 
@@ -1121,6 +1131,7 @@ Window::~Window()
 	 * may be removed by a single call to ~Window by means of the
 	 * DeleteChildWindows function.
 	 */
+	if (this->counted_class != WC_INVALID) _window_class_count[this->counted_class]--;
 	const_cast<volatile WindowClass &>(this->window_class) = WC_INVALID;
 }
 
@@ -1442,6 +1453,16 @@ static void RemoveWindowFromZOrdering(Window *w)
 	w->z_front = w->z_back = nullptr;
 }
 
+/**
+ * Check whether there might be windows of a window class.
+ * @param cls Window class
+ * @return False if there are certainly no windows of the class.
+ */
+static inline bool MayHaveWindowsOfClass(WindowClass cls)
+{
+	return cls >= NUM_COUNTED_WINDOW_CLASSES || _window_class_count[cls] != 0;
+}
+
 /**
  * On clicking on a window, make it the frontmost window of all windows with an equal
  * or lower z-priority. The window is marked dirty for a repaint
@@ -1466,6 +1487,10 @@ void Window::InitializeData(WindowNumber window_number)
 {
 	/* Set up window properties; some of them are needed to set up smallest size below */
 	this->window_class = this->window_desc->cls;
+	if (this->window_class < NUM_COUNTED_WINDOW_CLASSES) {
+		this->counted_class = this->window_class;
+		_window_class_count[this->counted_class]++;
+	}
 	this->SetWhiteBorder();
 	if (this->window_desc->default_pos == WDP_CENTER) this->flags |= WF_CENTERED;
 	this->owner = INVALID_OWNER;
@@ -1867,10 +1892,26 @@ void Window::InitNested(WindowNumber window_number)
  * Empty constructor, initialization has been moved to #InitNested() called from the constructor of the derived class.
  * @param desc The description of the window.
  */
-Window::Window(WindowDesc *desc) : window_desc(desc), mouse_capture_widget(-1)
+Window::Window(WindowDesc *desc) : counted_class(WC_INVALID), window_desc(desc), mouse_capture_widget(-1)
 {
 }
 
+/**
+ * Change the class of an initialised window, e.g. when one window description
+ * is used for windows of several classes.
+ * @param cls The new class of the window.
+ */
+void Window::ChangeWindowClass(WindowClass cls)
+{
+	if (this->counted_class != WC_INVALID) _window_class_count[this->counted_class]--;
+	this->window_class = cls;
+	this->counted_class = WC_INVALID;
+	if (cls < NUM_COUNTED_WINDOW_CLASSES) {
+		this->counted_class = cls;
+		_window_class_count[cls]++;
+	}
+}
+
 /**
  * Do a search for a window at specific coordinates. For this we start
  * at the topmost window, obviously and work our way down to the bottom
@@ -1899,6 +1940,7 @@ void InitWindowSystem()
 
 	_z_back_window = nullptr;
 	_z_front_window = nullptr;
+	memset(_window_class_count, 0, sizeof(_window_class_count));
 	_focused_window = nullptr;
 	_mouseover_last_w = nullptr;
 	_last_scroll_window = nullptr;
@@ -1907,6 +1949,7 @@ void InitWindowSystem()
 
 	NWidgetLeaf::InvalidateDimensionCache(); // Reset cached sizes of several widgets.
 	NWidgetScrollbar::InvalidateDimensionCache();
+	ResetViewportLodColours(); // The colours of the tiles of a previous game.
 
 	ShowFirstError();
 }
@@ -1929,6 +1972,7 @@ void UnInitWindowSystem()
 
 	_z_front_window = nullptr;
 	_z_back_window = nullptr;
+	memset(_window_class_count, 0, sizeof(_window_class_count));
 }
 
 /**
@@ -3147,6 +3191,7 @@ void UpdateWindows()
 
 	PerformanceMeasurer framerate(PFE_DRAWING);
 	PerformanceAccumulator::Reset(PFE_DRAWWORLD);
+	WindowPaintAccumulator::Reset();
 
 	CallWindowRealtimeTickEvent(delta_ms);
 
@@ -3218,6 +3263,8 @@ void UpdateWindows()
  */
 void SetWindowDirty(WindowClass cls, WindowNumber number)
 {
+	if (!MayHaveWindowsOfClass(cls)) return;
+
 	const Window *w;
 	FOR_ALL_WINDOWS_FROM_BACK(w) {
 		if (w->window_class == cls && w->window_number == number) w->SetDirty();
@@ -3232,6 +3279,8 @@ void SetWindowDirty(WindowClass cls, WindowNumber number)
  */
 void SetWindowWidgetDirty(WindowClass cls, WindowNumber number, byte widget_index)
 {
+	if (!MayHaveWindowsOfClass(cls)) return;
+
 	const Window *w;
 	FOR_ALL_WINDOWS_FROM_BACK(w) {
 		if (w->window_class == cls && w->window_number == number) {
@@ -3246,6 +3295,8 @@ void SetWindowWidgetDirty(WindowClass cls, WindowNumber number, byte widget_inde
  */
 void SetWindowClassesDirty(WindowClass cls)
 {
+	if (!MayHaveWindowsOfClass(cls)) return;
+
 	Window *w;
 	FOR_ALL_WINDOWS_FROM_BACK(w) {
 		if (w->window_class == cls) w->SetDirty();
@@ -3261,8 +3312,13 @@ void Window::InvalidateData(int data, bool gui_scope)
 {
 	this->SetDirty();
 	if (!gui_scope) {
-		/* Schedule GUI-scope invalidation for next redraw. */
-		this->scheduled_invalidation_data.push_back(data);
+		/* Schedule GUI-scope invalidation for next redraw. GUI-scope invalidations only
+		 * look at the state at the time of the redraw, so an invalidation with the same
+		 * data that is already scheduled is moved to the end instead of being repeated. */
+		std::vector<int> &scheduled = this->scheduled_invalidation_data;
+		auto it = std::find(scheduled.begin(), scheduled.end(), data);
+		if (it != scheduled.end()) scheduled.erase(it);
+		scheduled.push_back(data);
 	}
 	this->OnInvalidateData(data, gui_scope);
 }
@@ -3319,6 +3375,8 @@ void Window::ProcessHighlightedInvalidations()
  */
 void InvalidateWindowData(WindowClass cls, WindowNumber number, int data, bool gui_scope)
 {
+	if (!MayHaveWindowsOfClass(cls)) return;
+
 	Window *w;
 	FOR_ALL_WINDOWS_FROM_BACK(w) {
 		if (w->window_class == cls && w->window_number == number) {
@@ -3337,6 +3395,8 @@ void InvalidateWindowData(WindowClass cls, WindowNumber number, int data, bool g
  */
 void InvalidateWindowClassesData(WindowClass cls, int data, bool gui_scope)
 {
+	if (!MayHaveWindowsOfClass(cls)) return;
+
 	Window *w;
 
 	FOR_ALL_WINDOWS_FROM_BACK(w) {
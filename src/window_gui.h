@@ -279,8 +279,10 @@ protected:
 	void InitializeData(WindowNumber window_number);
 	void InitializePositionSize(int x, int y, int min_width, int min_height);
 	virtual void FindWindowPlacementAndResize(int def_width, int def_height);
+	void ChangeWindowClass(WindowClass cls);
 
 	std::vector<int> scheduled_invalidation_data;  ///< Data of scheduled OnInvalidateData() calls.
+	WindowClass counted_class;                     ///< Class the window is counted as open for; unlike #window_class it is not reset before destruction.
 
 public:
 	Window(WindowDesc *desc);